@@ -0,0 +1,50 @@
+// 运行目录索引（tools/run_catalog.py，SQLite）的ROOT宏接口
+//   LatestRunFile("--particle neutron")  最新一个满足条件的run的ROOT文件
+//   CatalogQuery("--fields glass_thickness_mm,root_file --particle gamma")
+//                                        查询结果各行（按字段切分，时间倒序）
+// 过滤参数同 run_catalog.py query（--particle --source --material --job-key --min-events --where ...）。
+// 索引不可用（无python3、无数据目录或无记录）时退回旧做法：ls -dt data/*/scintillator_output.root。
+#ifndef NGAMMA_RUN_CATALOG_H
+#define NGAMMA_RUN_CATALOG_H
+
+#include "TString.h"
+#include "TSystem.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+inline TString CatalogTool()
+{
+  // 本文件在 analysis/ 下，查询工具在 ../tools/
+  TString dir = gSystem->DirName(__FILE__);
+  return TString::Format("python3 %s/../tools/run_catalog.py", dir.Data());
+}
+
+inline std::vector<std::vector<TString>> CatalogQuery(const char* args)
+{
+  std::vector<std::vector<TString>> rows;
+  TString out = gSystem->GetFromPipe(TString::Format("%s query %s --format tsv 2>/dev/null",
+                                                     CatalogTool().Data(), args));
+  std::istringstream lines(out.Data());
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::vector<TString> cells;
+    std::istringstream ss(line);
+    std::string cell;
+    while (std::getline(ss, cell, '\t')) cells.push_back(cell.c_str());
+    rows.push_back(cells);
+  }
+  return rows;
+}
+
+inline TString LatestRunFile(const char* filter = "")
+{
+  auto rows = CatalogQuery(TString::Format("%s --latest 1 --fields root_file", filter));
+  if (!rows.empty() && !rows[0].empty() && !gSystem->AccessPathName(rows[0][0])) return rows[0][0];
+  TString latest = gSystem->GetFromPipe("ls -dt data/*/scintillator_output.root 2>/dev/null | head -1");
+  return latest.Length() ? latest : TString("build/scintillator_output.root");
+}
+
+#endif
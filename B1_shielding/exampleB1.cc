@@ -30,26 +30,154 @@
 #include "ActionInitialization.hh"
 #include "DetectorConstruction.hh"
 #include "CustomPhysicsList.hh"
+#include "ImportanceWorld.hh"
+#include "RecipePrescreener.hh"
+#include "RunConfiguration.hh"
 #include "G4PhysListFactory.hh"
 #include "G4VModularPhysicsList.hh"
 
 #include "G4RunManagerFactory.hh"
+#include "G4StateManager.hh"
+#include "G4SystemOfUnits.hh"
 #include "G4SteppingVerbose.hh"
 #include "G4UIExecutive.hh"
+#include "G4UIcommandStatus.hh"
 #include "G4UImanager.hh"
 #include "G4VisExecutive.hh"
+#include "G4GeometrySampler.hh"
+#include "G4ImportanceBiasing.hh"
+#include "G4ParallelWorldPhysics.hh"
+#include "G4WeightWindowAlgorithm.hh"
+#include "G4WeightWindowBiasing.hh"
 // #include "Randomize.hh"
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
 using namespace B1;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+namespace
+{
+
+// 执行一个作业宏；events>=0 时跳过宏里的 /run/beamOn，由队列统一指定事件数
+G4int ExecuteJobMacro(const std::string& macro, G4long events, G4UImanager* UImanager)
+{
+  if (events < 0) return UImanager->ApplyCommand("/control/execute " + macro);
+
+  std::ifstream fin(macro);
+  if (!fin.good()) {
+    G4cerr << "[QUEUE] Cannot open macro: " << macro << G4endl;
+    return fCommandNotFound;
+  }
+  std::string line;
+  while (std::getline(fin, line)) {
+    std::size_t begin = line.find_first_not_of(" \t");
+    if (begin == std::string::npos || line[begin] == '#') continue;
+    line.erase(0, begin);
+    if (line.compare(0, 11, "/run/beamOn") == 0) continue;
+    G4int status = UImanager->ApplyCommand(line);
+    if (status != fCommandSucceeded) return status;
+  }
+  return UImanager->ApplyCommand("/run/beamOn " + std::to_string(events));
+}
+
+// 批处理服务模式：逐行读取 "<配方文件> <宏文件> [事件数]"，在同一进程内依次运行。
+// 几何、物理列表与并行世界只初始化一次；换配方时只替换玻璃材料并重建材料相关的表
+// （见 DetectorConstruction::SetGlassCompositionFile）。配方写 "-" 表示沿用当前玻璃。
+// 每个作业结束打印一行 "[QUEUE] done ..."，供驱动脚本逐行跟踪进度；
+// 配方命令失败（文件缺失、解析错误、未知组分）时跳过该作业的宏，status 非0。
+G4int RunQueue(std::istream& queue, G4UImanager* UImanager)
+{
+  RunConfiguration::MarkSetupEnd();
+  G4int nJobs = 0;
+  G4int nFailed = 0;
+  std::string line;
+  while (std::getline(queue, line)) {
+    std::istringstream iss(line);
+    std::string recipe, macro;
+    if (!(iss >> recipe) || recipe[0] == '#') continue;
+    if (!(iss >> macro)) {
+      G4cerr << "[QUEUE] Malformed line (expected: recipe macro [events]): " << line << G4endl;
+      ++nFailed;
+      continue;
+    }
+    G4long events = -1;
+    if (!(iss >> events)) events = -1;
+
+    ++nJobs;
+    RunConfiguration::MarkJobStart();
+    G4int status = fCommandSucceeded;
+    if (recipe != "-") status = UImanager->ApplyCommand("/det/glass/compositionFile " + recipe);
+    if (status == fCommandSucceeded) {
+      status = ExecuteJobMacro(macro, events, UImanager);
+    }
+    else {
+      // 配方无效：不运行该作业，否则会把上一个玻璃的结果记在这个配方名下
+      G4cerr << "[QUEUE] recipe not loaded, job skipped: " << recipe << G4endl;
+    }
+    if (status != fCommandSucceeded) ++nFailed;
+    G4cout << "[QUEUE] done " << nJobs << " recipe=" << recipe << " macro=" << macro
+           << " status=" << status << G4endl;
+  }
+  G4cout << "[QUEUE] finished: " << nJobs << " jobs, " << nFailed << " failed" << G4endl;
+  return nFailed;
+}
+
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 int main(int argc, char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  // 命令行：exampleB1 [-t N | --threads N] [--queue file|-] [macro]
+  // 线程数优先取命令行，其次取环境变量 NGAMMA_THREADS；<=1 时使用串行run manager
+  // --queue：批处理服务模式，先执行可选的 macro（公共设置），再逐行运行队列（"-" 为标准输入）
+  // --prescreen list [--prescreen-out csv] [--prescreen-energy MeV]：不输运，只按截面数据
+  //   给出配方列表中各玻璃的衰减/俘获/移出截面与Pareto排名（见 RecipePrescreener）
+  G4String macroFile;
+  G4String queueFile;
+  G4String prescreenFile;
+  G4String prescreenOut = "prescreen.csv";
+  G4double prescreenEnergy = 662*keV;
+  G4int nThreads = 0;
+  for (G4int i = 1; i < argc; ++i) {
+    G4String arg = argv[i];
+    if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+      nThreads = std::atoi(argv[++i]);
+    }
+    else if (arg == "--queue" && i + 1 < argc) {
+      queueFile = argv[++i];
+    }
+    else if (arg == "--prescreen" && i + 1 < argc) {
+      prescreenFile = argv[++i];
+    }
+    else if (arg == "--prescreen-out" && i + 1 < argc) {
+      prescreenOut = argv[++i];
+    }
+    else if (arg == "--prescreen-energy" && i + 1 < argc) {
+      prescreenEnergy = std::atof(argv[++i]) * MeV;
+    }
+    else {
+      macroFile = arg;
+    }
+  }
+  if (nThreads <= 0) {
+    const char* envThreads = std::getenv("NGAMMA_THREADS");
+    nThreads = envThreads ? std::atoi(envThreads) : 1;
+  }
+
+  // Detect interactive mode (if no macro) and define UI session
   //
   G4UIExecutive* ui = nullptr;
-  if (argc == 1) {
+  if (macroFile.empty() && queueFile.empty() && prescreenFile.empty()) {
     ui = new G4UIExecutive(argc, argv);
   }
 
@@ -60,14 +188,48 @@ int main(int argc, char** argv)
   G4int precision = 4;
   G4SteppingVerbose::UseBestUnit(precision);
 
-  // Construct the run manager (force single thread for ROOT compatibility)
+  // Construct the run manager
+  // 多线程使用Tasking run manager；直方图与ntuple由G4AnalysisManager在master线程合并
   //
-  auto runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::Serial);
+  auto runManagerType = (nThreads > 1) ? G4RunManagerType::Tasking : G4RunManagerType::Serial;
+  auto runManager = G4RunManagerFactory::CreateRunManager(runManagerType);
+  if (nThreads > 1) {
+    runManager->SetNumberOfThreads(nThreads);
+  }
+  G4cout << "Run manager: " << ((nThreads > 1) ? "Tasking" : "Serial")
+         << ", threads = " << std::max(nThreads, 1) << G4endl;
 
   // Set mandatory initialization classes
   //
   // Detector construction
-  runManager->SetUserInitialization(new DetectorConstruction());
+  auto detector = new DetectorConstruction();
+
+  // 可选：几何重要性偏倚（并行世界分层，环境变量 NGAMMA_IMPORTANCE_LAYERS 开启）
+  // 或权窗（NGAMMA_WW_FILE 指定由先导计算生成的权窗文件，优先于重要性）
+  const G4String importanceWorldName = "ImportanceWorld";
+  std::vector<G4double> importances = ImportanceWorld::ImportancesFromEnvironment();
+  WeightWindowMesh weightWindows;
+  G4bool useWeightWindows = false;
+  if (const char* envWW = std::getenv("NGAMMA_WW_FILE")) {
+    if (envWW[0] != '\0') {
+      if (!weightWindows.Load(envWW)) {
+        G4Exception("main", "NGAMMA_WW_FILE", FatalException, "Cannot load weight-window file");
+      }
+      useWeightWindows = true;
+      if (!importances.empty()) {
+        G4cout << "NGAMMA_WW_FILE given: importance layers ignored in favour of weight windows" << G4endl;
+      }
+    }
+  }
+  ImportanceWorld* importanceWorld = nullptr;
+  std::vector<std::unique_ptr<G4GeometrySampler>> geometrySamplers;  // 须存活到run manager销毁之后
+  std::unique_ptr<G4WeightWindowAlgorithm> weightWindowAlgorithm;
+  if (useWeightWindows || !importances.empty()) {
+    importanceWorld = new ImportanceWorld(importanceWorldName, detector, importances);
+    if (useWeightWindows) importanceWorld->SetWeightWindows(weightWindows);
+    detector->RegisterParallelWorld(importanceWorld);
+  }
+  runManager->SetUserInitialization(detector);
 
   // Physics list
   {
@@ -78,6 +240,28 @@ int main(int argc, char** argv)
     auto customPhysList = new CustomPhysicsList();
     customPhysList->SetEMPhysicsOption(emPhysicsOption);
     customPhysList->SetVerboseLevel(1);
+
+    if (useWeightWindows) {
+      // 权窗：只对文件中的粒子，边界与碰撞处均检查
+      geometrySamplers.push_back(std::make_unique<G4GeometrySampler>(importanceWorld->GetWorldVolume(), weightWindows.particle));
+      geometrySamplers.back()->SetParallel(true);
+      weightWindowAlgorithm = std::make_unique<G4WeightWindowAlgorithm>(
+        WeightWindowMesh::kUpperLimitFactor, WeightWindowMesh::kSurvivalFactor, WeightWindowMesh::kMaxSplits);
+      customPhysList->RegisterPhysics(new G4WeightWindowBiasing(geometrySamplers.back().get(), weightWindowAlgorithm.get(),
+                                                                onBoundaryAndCollision, importanceWorldName));
+      customPhysList->RegisterPhysics(new G4ParallelWorldPhysics(importanceWorldName));
+      G4cout << "Weight windows enabled for " << weightWindows.particle << G4endl;
+    }
+    else if (importanceWorld) {
+      // 每种偏倚粒子一个采样器；并行世界的体积指针在物理初始化时由IStore补上
+      for (const auto& particle : ImportanceWorld::BiasedParticlesFromEnvironment()) {
+        geometrySamplers.push_back(std::make_unique<G4GeometrySampler>(importanceWorld->GetWorldVolume(), particle));
+        geometrySamplers.back()->SetParallel(true);
+        customPhysList->RegisterPhysics(new G4ImportanceBiasing(geometrySamplers.back().get(), importanceWorldName));
+        G4cout << "Importance biasing enabled for " << particle << G4endl;
+      }
+      customPhysList->RegisterPhysics(new G4ParallelWorldPhysics(importanceWorldName));
+    }
     runManager->SetUserInitialization(customPhysList);
     
     G4cout << "=== Physics List Configuration ===" << G4endl;
@@ -102,14 +286,36 @@ int main(int argc, char** argv)
 
   // Get the pointer to the User Interface manager
   auto UImanager = G4UImanager::GetUIpointer();
+  // 配置哈希（RunConfiguration）需要完整的命令历史，缺省只保留20条
+  UImanager->SetMaxHistSize(1000000);
 
   // Process macro or start UI session
   //
+  G4int exitCode = 0;
   if (!ui) {
     // batch mode
     G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command + fileName);
+    if (!macroFile.empty()) UImanager->ApplyCommand(command + macroFile);
+    if (!prescreenFile.empty()) {
+      if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_PreInit) {
+        UImanager->ApplyCommand("/run/initialize");
+      }
+      // 写出了排名即成功；个别配方解析失败记在CSV中，不影响退出码
+      exitCode = (RecipePrescreener(prescreenEnergy).Run(prescreenFile, prescreenOut) < 0) ? 1 : 0;
+    }
+    else if (queueFile == "-") {
+      exitCode = (RunQueue(std::cin, UImanager) > 0) ? 1 : 0;
+    }
+    else if (!queueFile.empty()) {
+      std::ifstream queue(queueFile);
+      if (!queue.good()) {
+        G4cerr << "Cannot open queue file: " << queueFile << G4endl;
+        exitCode = 2;
+      }
+      else {
+        exitCode = (RunQueue(queue, UImanager) > 0) ? 1 : 0;
+      }
+    }
   }
   else {
     // interactive mode
@@ -125,6 +331,7 @@ int main(int argc, char** argv)
 
   delete visManager;
   delete runManager;
+  return exitCode;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
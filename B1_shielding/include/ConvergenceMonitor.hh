@@ -0,0 +1,119 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/ConvergenceMonitor.hh
+/// \brief Definition of the B1::ConvergenceMonitor class
+
+#ifndef B1ConvergenceMonitor_h
+#define B1ConvergenceMonitor_h 1
+
+#include "TallyStatistics.hh"
+#include "globals.hh"
+
+#include <array>
+#include <atomic>
+#include <ctime>
+
+class G4GenericMessenger;
+
+namespace B1
+{
+
+/// 收敛控制的运行长度：读取 RunAction 的积分计分量按历史统计（TallyStatistics，
+/// 唯一的矩累加器），用相对误差 R 与方差的方差 VOV 判断，达到用户目标
+/// （/scoring/convergence/target）或 CPU 时间预算耗尽时提前结束run。
+///
+/// 每个线程一份（由RunAction持有）：每 checkInterval 个事件加锁，把本线程统计
+/// 自上次合并以来的增量并入全局统计并检查一次；满足停止条件后置全局标志，
+/// 各线程在下一个事件结束时软中止（AbortRun(true)，当前事件完整保留），
+/// 于是 /run/beamOn 的事件数只是上限。其它计分照常按实际处理的事件数归一化。
+/// run结束时的报告（convergence.txt）与 tally_statistics.txt 使用同一份合并后的统计
+/// 和同一个CPU时间，FOM一致。
+
+class ConvergenceMonitor
+{
+  public:
+    // 监控的积分计分量（每个源粒子，按权重）；RunAction 的按历史统计使用同一编号
+    enum Tally { kGammaTransmit = 0, kNeutronTransmit, kCapture, kDPA, kEdep, kNIEL, kNumTallies };
+    static const char* TallyName(G4int tally);   // UI/文件中的短名，如 "gamma"
+    static const char* TallyTitle(G4int tally);  // 报告中的说明
+
+    ConvergenceMonitor();
+    ~ConvergenceMonitor();
+
+    // 任一目标或CPU预算被设置时生效
+    G4bool IsActive() const;
+
+    // 事件结束（stats 已计入本事件）：按间隔把增量并入全局统计并检查；
+    // 已满足停止条件时中止本线程的run
+    void EndOfEvent(const TallyStatistics& stats);
+
+    // master在run开始时重置全局统计与计时
+    void BeginOfRun(G4bool isMaster);
+
+    // master：由合并后的统计打印并写出 convergence.txt（cpu 与 tally_statistics.txt 相同）
+    void Report(const G4String& outputDir, const TallyStatistics& stats, G4double nEvents,
+                G4double cpu) const;
+
+    // 本run的结束原因："converged"、"cpu_budget" 或 "beamOn_limit"（未提前停止）
+    static const char* StopReason();
+
+    // 本run开始（master BeginOfRun）以来的进程CPU时间，所有线程合计
+    static G4double CpuSeconds();
+
+  private:
+    void SetTarget(const G4String& args);
+    void ClearTargets();
+    void FlushLocal(const TallyStatistics& stats);
+    // 在全局统计上检查停止条件（调用方持锁）
+    G4bool CheckConverged() const;
+
+    // 配置（UI命令，广播到各线程）
+    std::array<G4double, kNumTallies> fTargetR{};  // 0 = 不作为停止条件
+    G4double fMaxVOV = 0.1;
+    G4int fMinEvents = 10000;
+    G4int fCheckInterval = 1000;
+    G4double fCpuBudget = 0.;  // s；0 = 不限
+
+    // 本线程状态：上次合并时的统计与此后的事件数
+    TallyStatistics fFlushed{"ConvergenceFlushed", kNumTallies};
+    G4int fLocalEvents = 0;
+
+    G4GenericMessenger* fMessenger = nullptr;
+
+    // 所有线程共享的run级状态
+    static TallyStatistics fGlobal;
+    static G4double fGlobalEvents;
+    static std::atomic<G4bool> fStopRequested;
+    static std::atomic<G4int> fStopReason;  // 0 = 未停止，1 = 收敛，2 = CPU预算
+    static std::clock_t fCpuStart;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
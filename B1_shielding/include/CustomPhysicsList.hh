@@ -15,9 +15,25 @@ public:
   
   // 设置电磁物理选项
   void SetEMPhysicsOption(G4int option);
+
+  // 物理表磁盘缓存（NGAMMA_CACHE_DIR/phys/<key>/）：
+  // SetCuts时若缓存存在则从中读取；首次构建后由master在run开始时写入
+  void StorePhysicsTablesIfNeeded();
+  G4String GetTableCacheKey() const { return fTableCacheKey; }
+  // run之间换材料（如换玻璃配方）后由master调用：按新材料重算缓存键，
+  // 有对应缓存则读取，否则下一次构建后写入
+  void ResetTableCache();
   
 private:
+  // 缓存键：EM选项、各粒子cut、各区域cut、EM表参数、几何中所用材料的组成与Geant4版本
+  G4String ComputeTableCacheKey() const;
+  void ConfigureTableCache();
+
   G4int fEMPhysicsOption; // 0=Standard_option4, 1=Livermore, 2=LowEP
+  G4String fTableCacheKey;
+  G4String fTableCacheDir;      // 空表示未启用缓存
+  G4bool fTablesRetrieved = false;
+  G4bool fTablesStored = false;
   
   // 截断值
   G4double cutForGamma;
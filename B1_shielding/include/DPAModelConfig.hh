@@ -56,12 +56,10 @@ public:
     }
 
 private:
-    static DPAModelType fCurrentModel;
+    // 默认使用NRT模型（run期间只读，各线程共享）
+    inline static DPAModelType fCurrentModel = DPAModelType::NRT;
 };
 
-// 默认使用NRT模型
-DPAModelType DPAModelConfig::fCurrentModel = DPAModelType::NRT;
-
 // DPA模型选择器
 class DPAModelSelector {
 public:
@@ -0,0 +1,117 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/DamageFunctionTable.hh
+/// \brief Definition of the B1::DamageFunctionTable class
+
+#ifndef B1DamageFunctionTable_h
+#define B1DamageFunctionTable_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+namespace B1
+{
+
+struct MaterialScoringRecord;
+
+/// DPA/NIEL损伤函数引擎。
+///
+/// 对每个（粒子种类, 材料）在对数能量网格上预先计算反冲能、核/电子阻止本领、
+/// NRT与SRIM的DPA系数以及NIEL系数，逐步计算只做一次O(1)插值。
+/// master线程在每个run开始时（MaterialScoringTable之后）构建，run期间只读共享。
+/// 设置环境变量 NGAMMA_CACHE_DIR 后，网格以二进制形式缓存到 <dir>/damage/ 下，
+/// 键为材料组成、位移阈值与网格参数的哈希。
+/// 新的损伤模型只需修改 EvaluateRow()，逐步开销不变。
+
+class DamageFunctionTable
+{
+  public:
+    enum Species { kNeutron = 0, kProton, kGamma, kOther, kNumSpecies };
+
+    enum Column {
+      kRecoilEnergy = 0,     // 反冲能 T(E)
+      kNuclearStopping,      // 核阻止本领 Sn(E)
+      kElectronicStopping,   // 电子阻止本领 Se(E)
+      kNRTFactor,            // NRT: dpa = 系数 * edep / stepLength
+      kSRIMPerLength,        // SRIM: dpa = 系数 * stepLength
+      kNIELPerLength,        // NIEL 按步长计的部分
+      kNIELPerStep,          // NIEL 每步固定部分（中子PKA）
+      kNumColumns
+    };
+
+    /// 单步查表结果：相邻两个网格点及插值权重
+    struct Cursor
+    {
+      const G4double* lo = nullptr;
+      const G4double* hi = nullptr;
+      G4double t = 0.;
+      G4double Get(Column c) const { return lo[c] + t * (hi[c] - lo[c]); }
+    };
+
+    static DamageFunctionTable& Instance();
+
+    // 为MaterialScoringTable中的全部材料构建网格（仅在事件循环之外调用）
+    void Build();
+
+    // 查表；材料未登记时返回false
+    G4bool Lookup(std::size_t materialIndex, Species species, G4double energy, Cursor& cursor) const;
+
+    static Species SpeciesOf(G4int pdgCode);
+
+    // 解析模型：计算单个能量点的全部列（构建网格与未命中回退共用）
+    static void EvaluateRow(Species species, G4double energy,
+                            const MaterialScoringRecord& rec, G4double* row);
+
+  private:
+    DamageFunctionTable() = default;
+
+    // 解析物理模型（原SteppingAction中的逐步计算）
+    static G4double RecoilEnergy(G4double energy, Species species, G4double atomicWeight);
+    static G4double NuclearStoppingPower(G4double energy, Species species);
+    static G4double ElectronicStoppingPower(G4double energy, Species species);
+    static G4double LindhardFraction(G4double recoilEnergy);
+
+    G4bool LoadCache(const G4String& path, std::vector<G4double>& data) const;
+    void SaveCache(const G4String& path, const std::vector<G4double>& data) const;
+
+    // 对数能量网格
+    static constexpr G4int kPointsPerDecade = 20;
+    static constexpr G4int kNumDecades = 16;
+    static constexpr G4int kNumPoints = kPointsPerDecade * kNumDecades + 1;
+    G4double fLogEmin = 0.;
+    G4double fInvDeltaLog = 0.;
+
+    // fCurves[materialIndex]: kNumSpecies * kNumPoints * kNumColumns，行优先
+    std::vector<std::vector<G4double>> fCurves;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
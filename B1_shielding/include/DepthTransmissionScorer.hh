@@ -0,0 +1,102 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/DepthTransmissionScorer.hh
+/// \brief Definition of the B1::DepthTransmissionScorer class
+
+#ifndef B1DepthTransmissionScorer_h
+#define B1DepthTransmissionScorer_h 1
+
+#include "globals.hh"
+#include "TallyStatistics.hh"
+
+#include <vector>
+
+class G4Step;
+class G4LogicalVolume;
+class G4GenericMessenger;
+
+namespace B1
+{
+
+class DetectorConstruction;
+
+/// 深度分辨透射计分：在玻璃内若干深度（自上游面起算）放置虚拟平面，统计向 +z 穿过
+/// 每个平面的中子/γ（按步前能量分箱，权重计数）。平面0固定为上游入射面，
+/// 于是一次模拟即可给出厚度 d_i 的透射比 T_i/T_0 与屏蔽效率 1 - T_i/T_0。
+/// 平面不是几何边界：步为直线段，z1 < z_p <= z2 即计一次穿越（半开区间，止于平面的步
+/// 与从平面出发的下一步不会重复计数）。只计步前点在玻璃内的步，两个端面按几何容差
+/// 归入入射步/出射步。注意深处材料的反散射仍会回到浅层平面，
+/// 与单独模拟薄玻璃相比略偏高（电流型计数）。
+/// 每个线程一份（由RunAction持有），统计量按事件计方差并在run结束时合并；
+/// master 输出 depth_transmission.txt 并填充 Neutron_/Gamma_Depth_Transmit_E 两个H2
+/// （x = 平面号，y = 能量，每个源粒子）与 Depth_Plane_mm（各平面深度）。
+
+class DepthTransmissionScorer
+{
+  public:
+    static constexpr G4int kMaxPlanes = 33;    // 入射面 + 至多32个深度平面
+    static constexpr G4int kNumParticles = 2;  // 0 = neutron, 1 = gamma
+    static constexpr G4int kNumEnergyBins = 200;
+
+    DepthTransmissionScorer();
+    ~DepthTransmissionScorer();
+
+    // 预定义H2/H1（所有线程在RunAction构造时调用）
+    static void Book();
+
+    TallyStatistics& GetStatistics() { return fStatistics; }
+
+    // 每个run开始时由几何换算平面z坐标；未定义平面时计分关闭
+    void BeginOfRun(const DetectorConstruction* detector);
+    G4bool IsActive() const { return fPlaneZ.size() > 1; }
+    void Score(const G4Step* step, G4double weight);
+    void EndOfEvent() { if (IsActive()) fStatistics.EndOfHistory(); }
+
+    // master：输出表格、文本文件并填充直方图
+    void Report(G4int nEvents, const G4String& outputDir) const;
+
+  private:
+    void SetUniformPlanes(G4int nPlanes);
+    void AddPlane(const G4String& args);
+    void ClearPlanes() { fDepthSpecs.clear(); fUniformPlanes = 0; }
+    std::size_t BinIndex(G4int plane, G4int particle, G4int energyBin) const;
+
+    G4int fUniformPlanes = 0;          // /scoring/depth/planes K：厚度K等分
+    std::vector<G4double> fDepthSpecs;  // /scoring/depth/addPlane：显式深度
+    std::vector<G4double> fPlaneDepth;  // 本run的平面深度（升序，[0] = 0）
+    std::vector<G4double> fPlaneZ;      // 对应的z坐标
+    G4double fZBack = 0.;               // 下游面z坐标
+    const G4LogicalVolume* fScoringVolume = nullptr;
+    TallyStatistics fStatistics;
+    G4GenericMessenger* fMessenger = nullptr;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -50,15 +50,26 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     G4VPhysicalVolume* Construct() override;
     G4Material* DefineShieldingGlass();
 
-    // 设置玻璃配方文件路径（由UI命令触发）
-    void SetGlassCompositionFile(const G4String& path) { fGlassCompositionFile = path; }
+    // 设置玻璃配方文件路径（由UI命令触发）；几何已构建时就地替换玻璃材料。
+    // 配方无法读取、解析或含未知组分时发出警告、保留当前玻璃并返回false
+    G4bool SetGlassCompositionFile(const G4String& path);
     G4String GetGlassCompositionFile() const { return fGlassCompositionFile; }
 
     G4LogicalVolume* GetScoringVolume() const { return fScoringVolume; }
 
+    // 几何尺寸（Construct之后有效，供并行世界等使用）
+    G4double GetWorldSizeXY() const { return fWorldSizeXY; }
+    G4double GetWorldSizeZ() const { return fWorldSizeZ; }
+    G4double GetGlassSizeXY() const { return fGlassSizeXY; }
+    G4double GetGlassSizeZ() const { return fGlassSizeZ; }
+
   protected:
     G4LogicalVolume* fScoringVolume = nullptr;
     G4String fGlassCompositionFile;
+    G4double fWorldSizeXY = 0.;
+    G4double fWorldSizeZ = 0.;
+    G4double fGlassSizeXY = 0.;
+    G4double fGlassSizeZ = 0.;
     class DetectorMessenger* fMessenger = nullptr;
 };
 
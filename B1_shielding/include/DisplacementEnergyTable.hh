@@ -0,0 +1,78 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/DisplacementEnergyTable.hh
+/// \brief Definition of the B1::DisplacementEnergyTable class
+
+#ifndef B1DisplacementEnergyTable_h
+#define B1DisplacementEnergyTable_h 1
+
+#include "globals.hh"
+
+#include <array>
+
+namespace B1
+{
+
+/// 按原子序Z索引的位移阈值能量表（NRT/SRIM两套）。
+///
+/// GetNRT/GetSRIM 取值优先级（高到低，与原SteppingAction一致）：
+///  1. 内置的逐元素值（NRT/SRIM各一套，原先硬编码在SteppingAction中）
+///  2. SRIM_Ed.dat 中的条目（两种模型共用，只补充内置表没有的元素）
+///  3. 通用默认值 25 eV
+///
+/// 文件查找顺序：环境变量 NGAMMA_SRIM_ED_FILE，当前目录 SRIM_Ed.dat，
+/// 上级目录 ../SRIM_Ed.dat，源码目录下的 SRIM_Ed.dat。
+/// 首次调用Instance()时加载（master线程在事件循环前触发），之后各线程只读共享。
+
+class DisplacementEnergyTable
+{
+  public:
+    static constexpr G4int kMaxZ = 120;
+
+    static const DisplacementEnergyTable& Instance();
+
+    G4double GetNRT(G4int Z) const { return fNRT[Clamp(Z)]; }
+    G4double GetSRIM(G4int Z) const { return fSRIM[Clamp(Z)]; }
+    // 该元素是否由SRIM_Ed.dat给出
+    G4bool HasFileEntry(G4int Z) const { return fFromFile[Clamp(Z)]; }
+
+  private:
+    DisplacementEnergyTable();
+
+    void Load(const G4String& path);
+    static G4int Clamp(G4int Z) { return (Z < 0 || Z > kMaxZ) ? 0 : Z; }
+
+    std::array<G4double, kMaxZ + 1> fNRT{};
+    std::array<G4double, kMaxZ + 1> fSRIM{};
+    std::array<G4bool, kMaxZ + 1> fFromFile{};
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -32,6 +32,7 @@
 
 #include "G4UserEventAction.hh"
 #include "globals.hh"
+#include "TrackSampler.hh"
 
 class G4Event;
 
@@ -39,6 +40,11 @@ namespace B1
 {
 
 class RunAction;
+class ScoringBuffer;
+class WeightWindowGenerator;
+class FluenceScorer;
+class DepthTransmissionScorer;
+class PhaseSpaceWriter;
 
 /// Event action class
 
@@ -54,17 +60,34 @@ class EventAction : public G4UserEventAction
     void AddEdep(G4double edep) { fEdep += edep; }
     void AddDPA(G4double dpa) { fDPA += dpa; }  // 新增DPA累积函数
     void AddNIEL(G4double niel) { fNIEL += niel; }
+    // 透射（离开玻璃）的中子/γ权重与俘获数，按事件计入统计
+    void AddTransmission(G4int pdg, G4double weight);
+    void AddCapture(G4double weight) { fCaptures += weight; }
     
-    // 轨迹记录的转发
-    void FillTrack(G4int trackID, G4int parentID, G4int pdgCode, 
-                   G4double x, G4double y, G4double z, 
-                   G4double kineticEnergy, G4double time, G4int stepNumber);
+    // 本线程计分缓冲（由RunAction持有）
+    ScoringBuffer* GetScoringBuffer() const;
+    WeightWindowGenerator* GetWeightWindowGenerator() const;
+    FluenceScorer* GetFluenceScorer() const;
+    DepthTransmissionScorer* GetDepthScorer() const;
+    PhaseSpaceWriter* GetPhaseSpaceWriter() const;
+
+    // 本事件初级粒子能量（响应矩阵的 E_in）
+    G4double GetPrimaryEnergy() const { return fPrimaryEnergy; }
+
+    // 轨迹抽样（SteppingAction提交候选步，事件结束时写出TrackData）
+    TrackSampler& GetTrackSampler() { return fTrackSampler; }
 
   private:
     RunAction* fRunAction = nullptr;
     G4double fEdep = 0.;
     G4double fDPA = 0.;  // 新增DPA累积变量
     G4double fNIEL = 0.;
+    G4double fGammaTransmit = 0.;
+    G4double fNeutronTransmit = 0.;
+    G4double fCaptures = 0.;
+    G4double fPrimaryEnergy = 0.;
+    G4double fPrimaryWeight = 1.;  // 顶点权重 × 初级粒子权重（biasToSlab）
+    TrackSampler fTrackSampler;
 };
 
 }  // namespace B1
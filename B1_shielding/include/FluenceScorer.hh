@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/FluenceScorer.hh
+/// \brief Definition of the B1::FluenceScorer class
+
+#ifndef B1FluenceScorer_h
+#define B1FluenceScorer_h 1
+
+#include "globals.hh"
+#include "TallyStatistics.hh"
+
+#include <vector>
+
+class G4Step;
+class G4GenericMessenger;
+
+namespace B1
+{
+
+class DetectorConstruction;
+
+/// 径迹长度注量估计器：phi = sum(w*l)/V（每个源粒子，cm^-2），按粒子（中子/γ）
+/// 与对数能量分箱，区域0为整块玻璃，其余为 /scoring/fluence/addLayer 定义的
+/// 玻璃内薄层（横向覆盖玻璃截面）。步在层内的长度按直线段的z向重叠几何裁剪。
+/// 每个线程一份（由RunAction持有），统计量按事件计方差并在run结束时合并；
+/// master 输出 fluence_tally.txt（均值与相对误差）并把均值填入
+/// Neutron_Fluence / Gamma_Fluence 两个H2（x = 区域号，y = 能量）。
+
+class FluenceScorer
+{
+  public:
+    static constexpr G4int kMaxRegions = 16;   // 玻璃 + 至多15个薄层
+    static constexpr G4int kNumParticles = 2;  // 0 = neutron, 1 = gamma
+    static constexpr G4int kNumEnergyBins = 100;
+    static constexpr G4double kEminMeV = 1.e-9;
+    static constexpr G4double kEmaxMeV = 20.;  // 与 Neutron_Transmit_E、ResponseMatrix 的上限一致
+
+    FluenceScorer();
+    ~FluenceScorer();
+
+    // 预定义H2（所有线程在RunAction构造时调用）
+    static void Book();
+
+    TallyStatistics& GetStatistics() { return fStatistics; }
+
+    // 每个run开始时由几何更新区域体积
+    void BeginOfRun(const DetectorConstruction* detector);
+    void Score(const G4Step* step, G4double weight);
+    void EndOfEvent() { fStatistics.EndOfHistory(); }
+
+    // master：输出表格、文本文件并填充H2
+    void Report(G4int nEvents, const G4String& outputDir) const;
+
+  private:
+    struct Region
+    {
+      G4double zMin;
+      G4double zMax;
+      G4double volume;
+    };
+
+    void AddLayer(const G4String& args);
+    void ClearLayers() { fLayerSpecs.clear(); }
+    std::size_t BinIndex(G4int region, G4int particle, G4int energyBin) const;
+
+    std::vector<std::pair<G4double, G4double>> fLayerSpecs;  // (中心z, 厚度)
+    std::vector<Region> fRegions;
+    G4double fInvLogBinWidth = 0.;
+    TallyStatistics fStatistics;
+    G4GenericMessenger* fMessenger = nullptr;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,86 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/GlassMaterialRegistry.hh
+/// \brief Definition of the B1::GlassMaterialRegistry class
+
+#ifndef B1GlassMaterialRegistry_h
+#define B1GlassMaterialRegistry_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class G4Material;
+
+namespace B1
+{
+
+/// 玻璃材料登记表：元素与氧化物在进程内只定义一次；配方玻璃按归一化配方的哈希缓存，
+/// 相同配方（无论来自哪个文件、组分顺序如何）复用同一个 G4Material 及其已建好的物理表。
+/// 只在master线程（Construct / UI命令）中调用。
+
+class GlassMaterialRegistry
+{
+  public:
+    using Recipe = std::vector<std::pair<G4Material*, G4double>>;  // 氧化物, 百分比（未归一化）
+
+    static GlassMaterialRegistry& Instance();
+
+    // 按小写键名查找氧化物（sio2、al2o3、gd2o3 ...；quartz 为 sio2 的旧别名），未知返回nullptr
+    G4Material* FindOxide(const std::string& key);
+
+    // 查找或创建配方玻璃，材料名为 "ShieldingGlass_<哈希>"
+    G4Material* GetGlass(const Recipe& recipe, G4double density);
+
+    // 归一化配方的哈希：组分按名称排序、同名合并、质量分数取9位小数，再拼上密度
+    static std::uint64_t RecipeHash(const Recipe& recipe, G4double density);
+
+    // 读取配方文件（每行 "氧化物 百分比[%]"，# 为注释）并返回对应玻璃；
+    // 文件不存在、某行无法解析、含未知组分或没有正含量组分时返回nullptr，原因写入error
+    G4Material* GetGlassFromFile(const G4String& path, G4String* error = nullptr);
+
+    // 配方玻璃的密度（目前所有配方取同一值）
+    static G4double GlassDensity();
+
+  private:
+    GlassMaterialRegistry() = default;
+
+    void DefineOxides();
+
+    std::map<std::string, G4Material*> fOxides;
+    std::map<std::uint64_t, G4Material*> fGlasses;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,80 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/HashUtil.hh
+/// \brief 64-bit FNV-1a hashing and temp-name helpers for on-disk caches
+
+#ifndef B1HashUtil_h
+#define B1HashUtil_h 1
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace B1
+{
+
+// FNV-1a 64位哈希（算法简单，便于外部脚本复现），用作缓存键
+inline std::uint64_t Fnv1a64(const std::string& text)
+{
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : text) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+inline std::string HashToHex(std::uint64_t hash)
+{
+  char buf[17];
+  std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+  return std::string(buf);
+}
+
+// 缓存先写临时文件/目录再改名：后缀含进程号与进程内计数，
+// 并行作业（job_scheduler.py）与同一进程的多次写入互不冲突
+inline std::string TempSuffix()
+{
+  static std::atomic<unsigned> counter{0};
+#ifdef _WIN32
+  const long pid = _getpid();
+#else
+  const long pid = static_cast<long>(getpid());
+#endif
+  return ".tmp" + std::to_string(pid) + "_" + std::to_string(counter++);
+}
+
+}  // namespace B1
+
+#endif
@@ -0,0 +1,99 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/ImportanceWorld.hh
+/// \brief Definition of the B1::ImportanceWorld class
+
+#ifndef B1ImportanceWorld_h
+#define B1ImportanceWorld_h 1
+
+#include "G4VUserParallelWorld.hh"
+#include "globals.hh"
+
+#include <vector>
+
+#include "WeightWindowMesh.hh"
+
+class G4VPhysicalVolume;
+
+namespace B1
+{
+
+class DetectorConstruction;
+
+/// 几何重要性偏倚/权窗的并行世界。
+///
+/// 把 ShieldingGlass 沿 z 均分为 N 层（横向覆盖整个世界，避免侧向边界），
+/// 第 i 层的重要性为 I_i；玻璃下游区域沿用最后一层的重要性，其余（上游与世界）为1。
+/// 重要性增大处由 G4ImportanceProcess 分裂、减小处轮盘赌，轨迹权重随之变化，
+/// 所有计分均按步前点权重加权。
+///
+/// 由环境变量在初始化前配置（与 EM_PHYSICS_OPTION 相同的方式）：
+///   NGAMMA_IMPORTANCE_LAYERS  层数N（未设置或<=0时关闭偏倚）
+///   NGAMMA_IMPORTANCE_BASE    几何级数 I_i = base^i（缺省2）
+///   NGAMMA_IMPORTANCE_VALUES  逗号分隔的逐层重要性，优先于BASE
+///   NGAMMA_BIAS_PARTICLES     逗号分隔的偏倚粒子（缺省 neutron,gamma）
+///
+/// 权窗模式（SetWeightWindows）下层数与z范围取自权窗文件，单元写入
+/// G4WeightWindowStore（上游=并行世界本身，下游单独一个单元），不再使用重要性。
+
+class ImportanceWorld : public G4VUserParallelWorld
+{
+  public:
+    ImportanceWorld(const G4String& worldName, const DetectorConstruction* detector,
+                    const std::vector<G4double>& importances);
+    ~ImportanceWorld() override = default;
+
+    // 改为权窗模式（须在初始化之前调用）
+    void SetWeightWindows(const WeightWindowMesh& mesh) { fWindows = mesh; fUseWindows = true; }
+
+    void Construct() override;
+    void ConstructSD() override {}
+
+    G4VPhysicalVolume* GetWorldVolume() const { return fGhostWorld; }
+
+    // 由环境变量读取逐层重要性；关闭时返回空
+    static std::vector<G4double> ImportancesFromEnvironment();
+    static std::vector<G4String> BiasedParticlesFromEnvironment();
+
+  private:
+    void FillImportanceStore() const;
+    void FillWeightWindowStore() const;
+
+    const DetectorConstruction* fDetector = nullptr;
+    std::vector<G4double> fImportances;
+    WeightWindowMesh fWindows;
+    G4bool fUseWindows = false;
+    std::vector<G4VPhysicalVolume*> fLayers;
+    G4VPhysicalVolume* fDownstream = nullptr;
+    G4VPhysicalVolume* fGhostWorld = nullptr;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,85 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/MaterialScoringTable.hh
+/// \brief Definition of the B1::MaterialScoringTable class
+
+#ifndef B1MaterialScoringTable_h
+#define B1MaterialScoringTable_h 1
+
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Material;
+
+namespace B1
+{
+
+/// 每种材料的计分常数（DPA/NIEL逐步计算所需），按 G4Material::GetIndex() 存放
+
+struct MaterialScoringRecord
+{
+  G4double meanA = 0.;         // 质量分数加权平均原子量
+  G4double meanZ = 10.;        // 质量分数加权平均原子序（NIEL用，缺省10）
+  G4double nielA = 20.;        // NIEL用平均原子量（缺省20）
+  G4double atomDensity = 0.;   // 原子数密度 N = rho*NA/A
+  G4double density = 0.;
+  G4double nrtEd = 25.*eV;   // NRT模型位移阈值
+  G4double srimEd = 25.*eV;  // SRIM模型位移阈值
+};
+
+/// 材料计分常数表：master线程在每个run开始时构建，run期间各线程只读共享
+
+class MaterialScoringTable
+{
+  public:
+    static MaterialScoringTable& Instance();
+
+    // 为材料表中的全部材料重建记录（仅在事件循环之外调用）
+    void Build();
+
+    // 未登记的材料返回nullptr
+    const MaterialScoringRecord* Find(const G4Material* material) const;
+
+    // 直接由材料计算一条记录（Build与未命中回退共用）
+    static MaterialScoringRecord MakeRecord(const G4Material* material);
+
+  private:
+    MaterialScoringTable() = default;
+
+    static G4double NRTDisplacementThreshold(const G4Material* material);
+    static G4double SRIMDisplacementThreshold(const G4Material* material);
+
+    std::vector<MaterialScoringRecord> fRecords;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/PhaseSpace.hh
+/// \brief Definition of the B1::PhaseSpaceWriter and B1::PhaseSpaceReader classes
+
+#ifndef B1PhaseSpace_h
+#define B1PhaseSpace_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <vector>
+
+class G4Step;
+class G4GenericMessenger;
+
+namespace B1
+{
+
+/// 相空间文件（.phsp）格式，本机字节序：
+///   头部32字节：char[8] "NGPHSP01"，uint32 记录长度(40)，uint32 保留，
+///               uint64 源历史数（写出文件的run的事件数），uint64 记录数
+///   每条记录40字节：int32 PDG，float x y z [mm]，float 方向余弦 u v w，
+///               float 动能 [MeV]，float 全局时间 [ns]，float 权重
+/// 回放的计分是 "每个记录" 的结果，换算为原运行 "每个源粒子" 时乘以 记录数/源历史数
+/// （打开文件时在日志中给出）；循环复用不改变这一换算。
+
+struct PhaseSpaceRecord
+{
+  std::int32_t pdg;
+  float x, y, z;
+  float u, v, w;
+  float energy;
+  float time;
+  float weight;
+};
+static_assert(sizeof(PhaseSpaceRecord) == 40, "phase-space record must be 40 bytes");
+
+/// 写出：记录离开玻璃（fScoringVolume）的粒子。
+/// 每个线程一份（由RunAction持有），记录先攒在线程内，满块或run结束时加锁追加到
+/// master在run开始时打开的共享文件（输出目录下 phasespace.phsp）；master在run结束时补写头部。
+
+class PhaseSpaceWriter
+{
+  public:
+    static constexpr std::size_t kBlockRecords = 4096;
+
+    PhaseSpaceWriter();
+    ~PhaseSpaceWriter();
+
+    G4bool IsEnabled() const { return fEnabled; }
+
+    // master：run开始时打开共享文件，run结束时补写头部并关闭
+    static void OpenShared(const G4String& path);
+    static void CloseShared(G4int nEvents);
+
+    // 由SteppingAction对离开玻璃的步调用
+    void Record(const G4Step* step, G4double weight);
+    // 把线程内剩余记录写入共享文件
+    void Flush();
+
+  private:
+    void SetParticles(const G4String& list);
+
+    G4bool fEnabled = false;
+    std::vector<G4int> fParticles;   // PDG过滤，空 = 全部
+    std::vector<PhaseSpaceRecord> fBlock;
+    G4GenericMessenger* fMessenger = nullptr;
+};
+
+/// 回放：所有线程共享一个读取位置，按块加锁读入，保证记录不重复分配；读到文件尾时
+/// 从头开始（并告警一次）。
+
+class PhaseSpaceReader
+{
+  public:
+    // 打开文件；同一文件再次打开时由master复位到第一条记录（worker重放的广播命令不复位）
+    static G4bool Open(const G4String& path);
+    static G4bool IsOpen();
+    // 读下一块（至多 n 条）到 block；文件为空时返回false
+    static G4bool NextBlock(std::vector<PhaseSpaceRecord>& block, std::size_t n);
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -34,6 +34,9 @@
 #include <vector>
 #include "G4Types.hh"
 #include "G4String.hh"
+#include "G4ThreeVector.hh"
+#include "TabulatedSpectrum.hh"
+#include "PhaseSpace.hh"
 
 class G4ParticleGun;
 class G4GeneralParticleSource;
@@ -45,6 +48,10 @@ namespace B1
 {
 
 /// Primary generator with built-in Cf-252 Watt spectrum rectangular surface source.
+/// response 模式：位置、方向与粒子由GPS宏给出，能量在 [emin, emax] 内对数均匀抽样（响应矩阵用）。
+/// phsp 模式：回放 /phsp/ 写出的相空间文件（可循环复用、绕z轴随机旋转）。
+/// MT/Tasking下master另持有一个实例（BuildForMaster创建，归master的RunAction所有），
+/// 只执行UI命令、不产生事件，供master在BeginOfRunAction中取得当前源的标签。
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
@@ -59,16 +66,26 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     void SetMode(const G4String& mode);
 
     // For run labeling
-    G4String GetSourceTag() const { return (fMode == SourceMode::CF252) ? "Cf252_Watt" : "GPS"; }
+    G4String GetSourceTag() const;
     G4String GetParticleTag() const;  // implemented in .cc
 
   private:
     // Internal helpers
-    void initializeCf252Spectrum();
     G4double sampleCf252EnergyMeV() const;
-
-    // Mode switch: cf252 (built-in) or gps (macro-controlled)
-    enum class SourceMode { CF252, GPS };
+    void SetSpectrumFile(const G4String& fileName);
+    // 朝玻璃前表面抽样方向，返回权重 = 真实pdf/偏倚pdf；不适用时返回false
+    G4bool sampleDirectionTowardSlab(const G4ThreeVector& position, G4ThreeVector& direction,
+                                     G4double& weight) const;
+    void UseWattSpectrum();
+    // response 模式能量范围：拒绝 emin <= 0 与 emin >= emax
+    void SetResponseEmin(G4double emin);
+    void SetResponseEmax(G4double emax);
+    void SetPhaseSpaceFile(const G4String& fileName);
+    void generatePhaseSpacePrimary(G4Event* anEvent);
+
+    // Mode switch: cf252 (built-in), gps (macro-controlled), response (GPS + log-uniform energy)
+    // or phsp (phase-space replay)
+    enum class SourceMode { CF252, GPS, RESPONSE, PHSP };
     SourceMode fMode;
 
     // Generators
@@ -78,16 +95,34 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     // UI
     G4GenericMessenger* fMessenger = nullptr;
 
-    // Cf-252 Watt spectrum parameters and lookup tables
+    // Cf-252 Watt spectrum parameters (exact sampling) or a tabulated spectrum (alias table)
     G4double fWattA_MeV;         // a parameter in MeV
     G4double fWattB_perMeV;      // b parameter in 1/MeV
-    std::vector<G4double> fEgridMeV;   // energy grid (MeV)
-    std::vector<G4double> fCdf;        // normalized CDF on grid
+    // 精确抽样的截断范围（MeV），同原先CDF网格
+    static constexpr G4double kWattEminMeV = 1e-6;
+    static constexpr G4double kWattEmaxMeV = 12.;
+    TabulatedSpectrum fSpectrum;       // /source/spectrum/file 加载的能谱
+    G4bool fUseTabulated = false;
+    G4GenericMessenger* fSpectrumMessenger = nullptr;
+
+    // response 模式的能量范围（对数均匀）
+    G4double fResponseEmin;
+    G4double fResponseEmax;
+    G4GenericMessenger* fResponseMessenger = nullptr;
+
+    // phsp 模式：线程内的记录块与复用计数（读取位置由 PhaseSpaceReader 在线程间共享）
+    std::vector<PhaseSpaceRecord> fPhspBlock;
+    std::size_t fPhspIndex = 0;
+    G4int fPhspUses = 0;
+    G4int fPhspRecycle = 1;       // 每条记录连续使用的次数
+    G4bool fPhspRotate = false;   // 每次使用绕z轴随机旋转（上游装置绕z轴对称时使用）
+    G4GenericMessenger* fPhspMessenger = nullptr;
 
     // Rectangular surface source geometry
     G4double fHalfX;             // half width (cm)
     G4double fHalfY;             // half height (cm)
     G4double fSourceZ;           // Z position (cm)
+    G4bool fBiasToSlab = false;  // /source/biasToSlab：只向玻璃所张立体角发射并加权
 };
 
 }  // namespace B1
@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/RecipePrescreener.hh
+/// \brief Definition of the B1::RecipePrescreener class
+
+#ifndef B1RecipePrescreener_h
+#define B1RecipePrescreener_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class G4Material;
+
+namespace B1
+{
+
+/// 配方的解析预筛（exampleB1 --prescreen）：不做输运，只由截面数据给出每个配方玻璃的
+///  - 光子质量衰减系数 μ/ρ（G4EmCalculator，当前EM物理选项，含相干散射）在一组能量上；
+///  - 中子宏观俘获截面 Σ_c（G4HadronicProcessStore，HP数据）在热能、1 eV、1 keV；
+///  - 快中子移出截面的近似 Σ_r = Σ_i n_i [σ_inel + σ_el·(1 - 2/(3A_i))]
+///    （非弹性 + 输运修正的弹性），在 2 MeV 与 Cf-252 Watt谱（1-15 MeV）平均下。
+/// 以 μ(参考能量)、Σ_c(热) 与 Σ_r(Watt) 三个目标（均越大越好）做非支配排序，
+/// 第1层即Pareto前沿；结果写成CSV并打印排名，供 tools/sweep_recipes.py 只把
+/// 前几层的配方送去完整输运。
+/// 截面表在一次空run（BeamOn(0)）中建立，因此需要在 /run/initialize 之后调用。
+
+class RecipePrescreener
+{
+  public:
+    struct Result
+    {
+      G4String recipe;            // 配方文件
+      G4Material* material = nullptr;
+      std::vector<G4double> muRho;  // cm2/g，对应 GammaEnergies()
+      G4double muRef = 0.;          // cm^-1，参考能量
+      G4double captureThermal = 0.; // cm^-1
+      G4double capture1eV = 0.;
+      G4double capture1keV = 0.;
+      G4double removal2MeV = 0.;    // cm^-1
+      G4double removalWatt = 0.;
+      G4int rank = 0;               // 非支配排序层号，1 = Pareto前沿
+    };
+
+    explicit RecipePrescreener(G4double gammaRefEnergy);
+
+    // recipeList：每行一个配方文件（# 为注释）；结果写到 outCsv，无法建立材料的配方
+    // 以 "# failed: <配方>" 注释行记在CSV末尾。返回失败的配方数；没有写出排名时返回 -1
+    G4int Run(const G4String& recipeList, const G4String& outCsv);
+
+    static const std::vector<G4double>& GammaEnergies();
+
+  private:
+    Result Evaluate(const G4String& recipe, G4Material* material) const;
+    G4double RemovalCrossSection(const G4Material* material, G4double energy) const;
+    static void RankPareto(std::vector<Result>& results);
+    G4bool Write(const std::vector<Result>& results, const std::vector<G4String>& failed,
+                 const G4String& outCsv) const;
+
+    G4double fGammaRefEnergy;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
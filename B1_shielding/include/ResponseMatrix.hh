@@ -0,0 +1,81 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/ResponseMatrix.hh
+/// \brief Definition of the B1::ResponseMatrix class
+
+#ifndef B1ResponseMatrix_h
+#define B1ResponseMatrix_h 1
+
+#include "globals.hh"
+
+namespace B1
+{
+
+class ScoringBuffer;
+
+/// 入射能量 × 出射能量响应矩阵 R(E_in, E_out)，用于离线谱折叠。
+///
+/// 每个事件的初级粒子能量 E_in 记入 Response_Primary_E（归一化用），
+/// 离开玻璃的中子/γ 与俘获γ 以其所属事件的 E_in 记入三个H2：
+/// Response_Neutron_Transmit、Response_Gamma_Transmit、Response_Capture_Gamma。
+/// 于是任意源谱 S(E_in) 的透射谱 = sum_i S_i * R(i, E_out) / N_i，
+/// 见 analysis/fold_response.C。配合 /source/mode response（对数均匀的宽谱初级）
+/// 一次模拟即可覆盖所有源谱。三个 200×200 的矩阵只在启用时预定义与填充：
+/// 环境变量 NGAMMA_SOURCE_MODE=response 或 NGAMMA_RESPONSE_MATRIX=1（须在启动时给出，
+/// 直方图在 RunAction 构造时定义），其他源模式的run不为此付出内存、文件大小与填充开销。
+/// 所有填充按轨迹/初级权重加权。逐步的透射/俘获填充与透射H1一样经线程内的
+/// ScoringBuffer 缓冲，每事件一次的初级能量直接交给分析管理器。
+
+class ResponseMatrix
+{
+  public:
+    // 入射能量轴（所有粒子共用）与出射能量轴（按粒子）：对数分箱
+    static constexpr G4int kNumBins = 200;
+    static constexpr G4double kEinMinMeV = 1.e-9;
+    static constexpr G4double kEmaxMeV = 20.;
+    static constexpr G4double kNeutronEoutMinMeV = 1.e-9;
+    static constexpr G4double kGammaEoutMinMeV = 1.e-3;
+
+    // 是否计分响应矩阵（进程内只读一次环境变量，所有线程一致）
+    static G4bool Enabled();
+
+    // 预定义H1/H2（启用时所有线程在RunAction构造时调用）
+    static void Book();
+
+    // 未启用时直接返回
+    static void FillPrimary(G4double primaryEnergy, G4double weight);
+    // pdg = 2112 / 22，其他粒子忽略
+    static void FillTransmit(ScoringBuffer& buffer, G4int pdg, G4double primaryEnergy, G4double exitEnergy,
+                             G4double weight);
+    static void FillCapture(ScoringBuffer& buffer, G4double primaryEnergy, G4double gammaEnergy, G4double weight);
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -34,6 +34,16 @@
 
 #include "G4Accumulable.hh"
 #include "globals.hh"
+#include "ScoringBuffer.hh"
+#include "TrackSampler.hh"
+#include "WeightWindowGenerator.hh"
+#include "FluenceScorer.hh"
+#include "DepthTransmissionScorer.hh"
+#include "PhaseSpace.hh"
+#include "ConvergenceMonitor.hh"
+#include "RunConfiguration.hh"
+
+#include <memory>
 
 class G4Run;
 class TTree;
@@ -41,17 +51,22 @@ class TTree;
 namespace B1
 {
 
+class PrimaryGeneratorAction;
+
 /// Run action class
 ///
 /// In EndOfRunAction(), it calculates the dose in the selected volume
 /// from the energy deposit accumulated via stepping and event actions.
 /// The computed dose is then printed on the screen.
+/// Histograms and ntuples are booked in the constructor on every thread;
+/// in MT/Tasking mode the worker copies are merged into the master file.
 
 class RunAction : public G4UserRunAction
 {
   public:
-    RunAction();
-    ~RunAction() override = default;
+    // masterSource：MT/Tasking下master的源实例（只用于取运行标签，归本对象所有）
+    explicit RunAction(PrimaryGeneratorAction* masterSource = nullptr);
+    ~RunAction() override;
 
     void BeginOfRunAction(const G4Run*) override;
     void EndOfRunAction(const G4Run*) override;
@@ -59,13 +74,42 @@ class RunAction : public G4UserRunAction
     void AddEdep(G4double edep);
     
     // 轨迹记录功能
-    void FillTrackData(G4int trackID, G4int parentID, G4int pdgCode, 
-                       G4double x, G4double y, G4double z, 
-                       G4double kineticEnergy, G4double time, G4int stepNumber);
+    void FillTrackData(G4int eventID, const TrackSampler::Record& rec);
+
+    // 本线程的计分缓冲（SteppingAction填入，事件/run结束时合并）
+    ScoringBuffer& GetScoringBuffer() { return fScoringBuffer; }
+
+    // 径迹长度注量估计器
+    FluenceScorer& GetFluenceScorer() { return fFluenceScorer; }
+    DepthTransmissionScorer& GetDepthScorer() { return fDepthScorer; }
+
+    // 玻璃出射面的相空间写出（/phsp/enable）
+    PhaseSpaceWriter& GetPhaseSpaceWriter() { return fPhaseSpaceWriter; }
+
+    // 收敛控制（/scoring/convergence/）：达到目标误差或CPU预算时提前结束run
+    ConvergenceMonitor& GetConvergenceMonitor() { return fConvergenceMonitor; }
+
+    // 积分计分量（透射、俘获、DPA、Edep、NIEL）的按历史统计，编号同 ConvergenceMonitor::Tally
+    TallyStatistics& GetHistoryStatistics() { return fHistoryStatistics; }
+
+    // 权窗先导计算的通量计分（未开启时为nullptr）
+    WeightWindowGenerator* GetWeightWindowGenerator() const { return fWeightWindowGenerator.get(); }
 
   private:
+    std::unique_ptr<PrimaryGeneratorAction> fMasterSource;
     G4Accumulable<G4double> fEdep = 0.;
     G4Accumulable<G4double> fEdep2 = 0.;
+    ScoringBuffer fScoringBuffer;
+    std::unique_ptr<WeightWindowGenerator> fWeightWindowGenerator;
+    FluenceScorer fFluenceScorer;
+    DepthTransmissionScorer fDepthScorer;
+    PhaseSpaceWriter fPhaseSpaceWriter;
+    ConvergenceMonitor fConvergenceMonitor;
+    TallyStatistics fHistoryStatistics{"HistoryTallies", ConvergenceMonitor::kNumTallies};
+    RunConfiguration fRunConfiguration;  // 配置哈希与 run_metadata.json
+
+    // master：打印并写出 tally_statistics.txt（均值、相对误差、FOM；cpu 为本run的CPU秒数）
+    void ReportHistoryStatistics(G4int nEvents, const G4String& outputDir, G4double cpu) const;
     
     // 粒子轨迹记录的TTree
     TTree* fTrackTree;
@@ -0,0 +1,104 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/RunConfiguration.hh
+/// \brief Definition of the B1::RunConfiguration class
+
+#ifndef B1RunConfiguration_h
+#define B1RunConfiguration_h 1
+
+#include "globals.hh"
+
+#include <tuple>
+#include <vector>
+
+class G4Run;
+class G4GenericMessenger;
+
+namespace B1
+{
+
+/// run的有效配置与结果缓存元数据。
+///
+/// 规范化配置由以下几行组成（顺序固定）：玻璃材料名（ShieldingGlass_<配方哈希>，
+/// 与配方文件路径、组分顺序和倍数无关）、玻璃厚度、缺省产生阈、影响物理的环境变量
+/// （EM_PHYSICS_OPTION、NGAMMA_SOURCE_MODE、偏倚相关变量），以及master的UI历史中
+/// 除纯输出/显示类命令之外的全部命令（GPS、/source/、/det/、/run/setCut、/scoring/ ...）。
+/// 其FNV-1a哈希 config_hash 不含事件数与随机数种子：config_hash 相同、种子不同的run
+/// 在统计上相容，可以合并或续算。
+/// master在run结束时把 config_hash、事件数、种子、结束原因与外部作业键（/metadata/jobKey，
+/// 由 tools/result_cache.py 生成）写入 run_metadata.json；该文件存在即表示run完整结束。
+/// 同时向数据目录下的 run_catalog.jsonl 追加一行（元数据 + 源 + 积分计分量均值与误差），
+/// tools/run_catalog.py 把它导入SQLite供跨run查询，分析宏不必逐个打开ROOT文件。
+
+class RunConfiguration
+{
+  public:
+    RunConfiguration();
+    ~RunConfiguration();
+
+    // 规范化配置行与其哈希（master线程调用）
+    static std::vector<G4String> CanonicalLines();
+    static G4String ConfigHash(const std::vector<G4String>& lines);
+
+    // master：写出 run_metadata.json；stopReason 为 ConvergenceMonitor::StopReason()，
+    // 未提前停止但事件数不足（/run/abort）时记为 "aborted"
+    void WriteMetadata(const G4Run* run, const G4String& outputDir, const G4String& stopReason) const;
+
+    // run目录之外的汇总量（由RunAction填写）
+    struct Summary
+    {
+      G4String particle;
+      G4String source;
+      G4double cpuSeconds = 0.;
+      G4double dose = 0.;
+      G4double doseRms = 0.;
+      std::vector<std::tuple<G4String, G4double, G4double>> tallies;  // 名称, 每历史均值, 相对误差
+    };
+    // master：向 <outputDir>/../run_catalog.jsonl 追加一行（多进程并发时加文件锁）
+    void AppendToCatalog(const G4Run* run, const G4String& outputDir, const Summary& summary) const;
+
+    // 批处理服务模式（exampleB1 --queue）：只计公共设置宏与当前作业的UI历史，
+    // 前面作业的命令不计入（每个作业宏自己给出完整的源设置）
+    static void MarkSetupEnd();
+    static void MarkJobStart();
+
+  private:
+    G4String fJobKey;
+    G4GenericMessenger* fMessenger = nullptr;
+
+    // 最后一次 /random/setSeeds 的参数；没有时为 "default"
+    static G4String CurrentSeeds();
+
+    static G4int fSetupHistoryEnd;  // -1 = 非服务模式，计入全部历史
+    static G4int fJobHistoryStart;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
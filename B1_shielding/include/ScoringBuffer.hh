@@ -0,0 +1,116 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/ScoringBuffer.hh
+/// \brief Definition of the B1::ScoringBuffer class
+
+#ifndef B1ScoringBuffer_h
+#define B1ScoringBuffer_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4GenericMessenger;
+
+namespace tools {
+namespace histo {
+class h1d;
+class h2d;
+}
+}
+
+namespace B1
+{
+
+/// 线程内计分缓冲区。
+///
+/// SteppingAction 中的透射/入射/俘获直方图（H1 3..9）与响应矩阵（H2 4..6）的填充
+/// 先追加到本线程的填充记录（槽号、坐标、权重），俘获记录先追加到向量中；
+/// 每 N 个事件（/scoring/flushInterval，缺省1000）以及run结束写文件之前，按记录直接填入
+/// 目标直方图（无分析管理器的ID查找与激活检查）并写 ActivationProducts ntuple。
+/// 合并只处理这段时间实际发生的填充，与直方图箱数无关；条目数、权重和与各阶矩与直接填充相同。
+/// 每个线程的 RunAction 持有一个实例；MT合并仍由分析管理器在 Write() 时完成。
+
+class ScoringBuffer
+{
+  public:
+    // 缓冲的H1编号区间（与RunAction中的预定义顺序一致）
+    static constexpr G4int kFirstH1 = 3;
+    static constexpr G4int kLastH1 = 9;
+    // 缓冲的H2编号区间（ResponseMatrix 的三个 E_in × E_out 矩阵）
+    static constexpr G4int kFirstH2 = 4;
+    static constexpr G4int kLastH2 = 6;
+
+    ScoringBuffer();
+    ~ScoringBuffer();
+
+    // 按已预定义直方图的分箱创建本线程缓冲（每个run开始时调用）
+    void Bind();
+
+    void FillH1(G4int id, G4double value, G4double weight = 1.);
+    void FillH2(G4int id, G4double xValue, G4double yValue, G4double weight = 1.);
+    void AddCapture(G4double preNeutronE, G4double captureGammaE, const G4ThreeVector& position,
+                    G4double weight = 1.);
+
+    // 事件结束计数，达到刷新间隔时合并
+    void EndOfEvent();
+    // 合并到分析管理器并清空缓冲
+    void Flush();
+
+  private:
+    struct FillRecord
+    {
+      G4int slot;
+      G4double x;
+      G4double y;
+      G4double weight;
+    };
+
+    struct CaptureRecord
+    {
+      G4double preNeutronE;
+      G4double captureGammaE;
+      G4ThreeVector position;
+      G4double weight;
+    };
+
+    std::vector<tools::histo::h1d*> fTargetH1;
+    std::vector<tools::histo::h2d*> fTargetH2;
+    std::vector<FillRecord> fFillsH1;
+    std::vector<FillRecord> fFillsH2;
+    std::vector<CaptureRecord> fCaptures;
+    G4int fFlushInterval = 1000;
+    G4int fEventsSinceFlush = 0;
+    G4GenericMessenger* fMessenger = nullptr;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
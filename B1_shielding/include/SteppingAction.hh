@@ -32,6 +32,8 @@
 
 #include "G4UserSteppingAction.hh"
 #include "globals.hh"  // for G4double/G4int
+#include "MaterialScoringTable.hh"
+#include "DamageFunctionTable.hh"
 
 class G4Material;
 class G4LogicalVolume;
@@ -57,22 +59,21 @@ class SteppingAction : public G4UserSteppingAction
     EventAction* fEventAction = nullptr;
     G4LogicalVolume* fScoringVolume = nullptr;
     
+    // 材料计分常数查找（run开始时构建的共享表）
+    const MaterialScoringRecord& GetMaterialRecord(const G4Material* material);
+    MaterialScoringRecord fFallbackRecord;  // 未登记材料的临时记录
+
+    // 损伤函数查表（DamageFunctionTable），未登记材料时用 fFallbackRow 现算
+    DamageFunctionTable::Cursor LookupDamage(const G4Step* step, const MaterialScoringRecord& rec);
+    G4double fFallbackRow[DamageFunctionTable::kNumColumns] = {};
+
     // DPA计算函数
-    G4double CalculateDPA(const G4Step* step);  // 主函数，根据配置选择模型
-    G4double CalculateNRT_DPA(const G4Step* step);  // NRT模型（默认）
-    G4double CalculateSRIM_DPA(const G4Step* step);  // SRIM模型（高精度）
-    G4double GetDisplacementThreshold(const G4Material* material);
-    G4double CalculateRecoilEnergy(G4double kineticEnergy, G4int pdgCode, G4double atomicWeight);
-    
-    // SRIM模型辅助函数
-    G4double CalculateNuclearStoppingPower(G4double energy, G4int pdgCode, const G4Material* material);
-    G4double CalculateElectronicStoppingPower(G4double energy, G4int pdgCode, const G4Material* material);
-    G4double GetSRIMDisplacementThreshold(const G4Material* material);
+    G4double CalculateDPA(const G4Step* step, const DamageFunctionTable::Cursor& dmg);  // 主函数，根据配置选择模型
+    G4double CalculateNRT_DPA(const G4Step* step, const DamageFunctionTable::Cursor& dmg);  // NRT模型（默认）
+    G4double CalculateSRIM_DPA(const G4Step* step, const DamageFunctionTable::Cursor& dmg);  // SRIM模型（高精度）
 
     // NIEL（非电离能量损失）完整版
-    G4double CalculateNIEL(const G4Step* step);
-    void ComputeAverageZA(const G4Material* material, G4double& Zbar, G4double& Abar) const;
-    G4double LindhardFraction(G4double recoilEnergy, G4double Zbar, G4double Abar) const;
+    G4double CalculateNIEL(const G4Step* step, const DamageFunctionTable::Cursor& dmg);
 };
 
 }  // namespace B1
@@ -0,0 +1,76 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/TabulatedSpectrum.hh
+/// \brief Definition of the B1::TabulatedSpectrum class
+
+#ifndef B1TabulatedSpectrum_h
+#define B1TabulatedSpectrum_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+namespace B1
+{
+
+/// 表格能谱的 O(1) 抽样器（Walker/Vose 别名表）。
+///
+/// 输入为 "E(MeV) 概率密度" 的点列（如 Cf252_Watt_spectrum.dat），在 [Emin, Emax]
+/// 上建细的对数网格，每箱概率 = 箱中心处线性插值的密度 × 箱宽；抽样时一个均匀数选箱
+/// （别名表，无二分查找），再一个均匀数在箱内线性取能量。
+/// 另提供 Watt 谱的精确抽样（Maxwell 抽样 + 平移，无表、无舍选）。
+
+class TabulatedSpectrum
+{
+  public:
+    static constexpr G4int kDefaultBins = 4096;
+
+    // 从文件加载并建表；失败返回false（保留原表）
+    G4bool Load(const G4String& fileName, G4int nBins = kDefaultBins);
+    // 由点列建表（energies 升序，MeV）
+    G4bool Build(const std::vector<G4double>& energies, const std::vector<G4double>& density,
+                 G4int nBins = kDefaultBins);
+
+    G4bool IsValid() const { return !fProb.empty(); }
+    // 返回能量（MeV）
+    G4double Sample() const;
+
+    // Watt 谱 f(E) ∝ exp(-E/a) sinh(sqrt(bE)) 在 [eMin, eMax] 内的精确抽样
+    // （a: MeV，b: 1/MeV，能量与返回值均为MeV；区间外的抽样重抽）
+    static G4double SampleWatt(G4double a, G4double b, G4double eMin, G4double eMax);
+
+  private:
+    std::vector<G4double> fEdges;   // 箱边界（MeV），nBins+1
+    std::vector<G4double> fProb;    // 别名表：本箱接受概率
+    std::vector<G4int> fAlias;      // 别名表：被拒时改取的箱
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,88 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/TallyStatistics.hh
+/// \brief Definition of the B1::TallyStatistics class
+
+#ifndef B1TallyStatistics_h
+#define B1TallyStatistics_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <vector>
+
+namespace B1
+{
+
+/// 按历史（事件）统计的分箱计分累积量。
+///
+/// 事件内的贡献先累加到暂存区，事件结束时 EndOfHistory() 把每个被触及箱的
+/// 历史总和 x 计入 sum(x^k), k = 1..4；未触及的箱贡献为0，无需处理。
+/// 由此得到每个源粒子的均值、相对误差 R = sqrt((<x^2>-<x>^2)/N)/<x> 与方差的方差 VOV。
+/// 作为 G4VAccumulable 注册后，各线程结果在run结束时合并到master；
+/// ConvergenceMonitor 在run中按增量（AddDifference）读取同一份统计。
+
+class TallyStatistics : public G4VAccumulable
+{
+  public:
+    TallyStatistics(const G4String& name, std::size_t nBins);
+    ~TallyStatistics() override = default;
+
+    void Score(std::size_t bin, G4double value);
+    void EndOfHistory();
+
+    // N 为历史总数（含零贡献的历史）
+    G4double Mean(std::size_t bin, G4double nHistories) const;
+    G4double RelativeError(std::size_t bin, G4double nHistories) const;
+    // VOV = sum((x-<x>)^4) / (sum((x-<x>)^2))^2 - 1/N（MCNP定义，应 < 0.1）
+    G4double VarianceOfVariance(std::size_t bin, G4double nHistories) const;
+
+    std::size_t Size() const { return fSum.size(); }
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    // 已结束历史的累加和：加上 current - previous（两者同箱数）；
+    // 用于把一个线程自上次合并以来的增量并入run中的全局统计
+    void AddDifference(const TallyStatistics& current, const TallyStatistics& previous);
+    // 复制已结束历史的累加和（不含本事件暂存区）
+    void CopySums(const TallyStatistics& other);
+
+  private:
+    std::vector<G4double> fSum;
+    std::vector<G4double> fSum2;
+    std::vector<G4double> fSum3;
+    std::vector<G4double> fSum4;
+    std::vector<G4double> fScratch;
+    std::vector<std::size_t> fTouched;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
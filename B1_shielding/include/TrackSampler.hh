@@ -0,0 +1,121 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/TrackSampler.hh
+/// \brief Definition of the B1::TrackSampler class
+
+#ifndef B1TrackSampler_h
+#define B1TrackSampler_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <cfloat>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+class G4Step;
+class G4GenericMessenger;
+
+namespace B1
+{
+
+/// TrackData 轨迹抽样器（每个线程一个，由 EventAction 持有）。
+///
+/// SteppingAction 只把计分体内的步交给 Offer()；Offer() 本身按粒子种类
+/// （/tracks/particles）与步后动能（/tracks/minEnergy、maxEnergy）过滤，通过的步作为候选，
+/// 每个事件用蓄水池抽样保留至多 /tracks/samplesPerEvent 条；随机数由 eventID 与 /tracks/seed 确定。
+/// 字节预算（/tracks/maxMB）在run开始时按 /run/beamOn 的事件数 N 分摊：每个事件的上限
+/// = 预算行数/N（不超过 samplesPerEvent）；不足每事件一行时只记录 eventID 为步长整数倍的事件。
+/// 因收敛或CPU预算提前停止的run只处理了部分事件，相应只用掉同样比例的预算。
+/// 哪些事件、各保留几条只由 eventID 决定，与线程数和事件调度无关，输出大小有上界，
+/// 也不会出现只写了一半的事件。
+
+class TrackSampler
+{
+  public:
+    struct Record
+    {
+      G4int trackID;
+      G4int parentID;
+      G4int pdgCode;
+      G4double x, y, z;        // cm
+      G4double kineticEnergy;  // MeV
+      G4double time;           // ns
+      G4int stepNumber;
+    };
+
+    TrackSampler();
+    ~TrackSampler();
+
+    void BeginOfEvent(G4int eventID);
+    // 提交一个候选步（内部做过滤与蓄水池抽样）
+    void Offer(const G4Step* step);
+    // 申请预算；成功返回本事件保留的记录，否则返回空
+    const std::vector<Record>& EndOfEvent();
+
+    // 由master在run开始/结束时调用：按本run事件数分摊预算、报告用量
+    static void ResetBudget(G4int nEvents);
+    static void PrintSummary();
+
+  private:
+    void SetParticles(const G4String& list);
+    void SetBudgetMB(G4double megabytes);
+    std::uint64_t NextRandom();
+
+    // 配置（UI命令）
+    G4bool fEnabled = true;
+    G4int fSamplesPerEvent = 20;
+    G4double fMinEnergy = 0.;
+    G4double fMaxEnergy = DBL_MAX;
+    G4int fSeed = 0;
+    std::set<G4int> fParticles;  // 空集合表示所有粒子
+
+    // 事件内状态
+    G4int fEventID = 0;
+    G4int fEventLimit = 0;  // 本事件保留条数上限（由预算分摊得出，0 = 本事件不记录）
+    std::uint64_t fCandidates = 0;
+    std::uint64_t fRngState = 0;
+    std::vector<Record> fReservoir;
+    std::vector<Record> fEmpty;
+
+    G4GenericMessenger* fMessenger = nullptr;
+
+    // 所有线程共享的run级字节预算
+    static constexpr std::uint64_t kBytesPerRow = 60;  // 5个int + 5个double（含EventID列）
+    static std::atomic<std::uint64_t> fBudgetBytes;
+    static std::atomic<std::uint64_t> fUsedBytes;
+    static std::atomic<std::uint64_t> fEventsInRun;
+    static std::atomic<std::uint64_t> fRowsWritten;
+    static std::atomic<std::uint64_t> fEventsDropped;
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,86 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/WeightWindowGenerator.hh
+/// \brief Definition of the B1::WeightWindowGenerator class
+
+#ifndef B1WeightWindowGenerator_h
+#define B1WeightWindowGenerator_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include "WeightWindowMesh.hh"
+
+#include <vector>
+
+namespace B1
+{
+
+/// 权窗生成器（类似MCNP的WWG，前向通量近似）。
+///
+/// 先导计算中在玻璃各层、各能群累加径迹长度通量 phi(i,g) = sum(w*l)，
+/// 每个线程一份，作为累积量在run结束时合并到master。
+/// 人口守恒方案：目标权重 w_t(i,g) = phi(i,g) / phi_ref，phi_ref 为第一层
+/// 通量最大能群的通量，使源粒子（权重1）落在窗内；下限取 w_t / 存活因子，
+/// 轮盘赌幸存者恰好获得目标权重。上游单元沿用第一层、下游沿用最后一层的窗。
+///
+/// NGAMMA_WW_GENERATE=<file> 开启，层数取 NGAMMA_WW_LAYERS（缺省10），
+/// 能群取 NGAMMA_WW_EBOUNDS，计分粒子取 NGAMMA_WW_PARTICLE（缺省neutron）。
+
+class WeightWindowGenerator : public G4VAccumulable
+{
+  public:
+    WeightWindowGenerator(const G4String& outputFile, const G4String& particle,
+                          G4int nLayers, const std::vector<G4double>& upperEnergies);
+    ~WeightWindowGenerator() override = default;
+
+    // 网格的z范围在几何构建后才确定（每个run开始时设置）
+    void SetExtent(G4double zMin, G4double zMax);
+
+    // 逐步计分：步中点z、步前能量、权重*步长
+    void Score(G4int pdgCode, G4double z, G4double energy, G4double weightedLength);
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    // master在run结束时调用：由通量生成下限权重并写文件
+    void WriteWindows() const;
+
+    static WeightWindowGenerator* CreateFromEnvironment();
+
+  private:
+    G4String fOutputFile;
+    G4int fPDGCode = 0;
+    WeightWindowMesh fMesh;
+    std::vector<G4double> fFlux;  // [layer * nGroups + group]
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
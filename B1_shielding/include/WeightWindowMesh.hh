@@ -0,0 +1,85 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/WeightWindowMesh.hh
+/// \brief Definition of the B1::WeightWindowMesh class
+
+#ifndef B1WeightWindowMesh_h
+#define B1WeightWindowMesh_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+namespace B1
+{
+
+/// 权窗的空间-能量网格与下限权重。
+///
+/// 空间单元：0 = 上游（并行世界本身），1..N = 玻璃沿z均分的N层，N+1 = 下游；
+/// 能群由升序的能量上界给出（最后一群上界自动放宽到1 TeV，保证所有能量有窗）。
+/// 文件为文本格式，由 WeightWindowGenerator 写出、生产运行读入：
+///   particle <name>
+///   layers <N> <zMin/mm> <zMax/mm>
+///   ebounds <G> <E1/MeV> ... <EG/MeV>
+///   cell <i> <wL_1> ... <wL_G>        (i = 0..N+1)
+
+class WeightWindowMesh
+{
+  public:
+    // G4WeightWindowAlgorithm参数：上限 = 下限*5，存活权重 = 下限*3，单次最多分裂5份
+    static constexpr G4double kUpperLimitFactor = 5.;
+    static constexpr G4double kSurvivalFactor = 3.;
+    static constexpr G4int kMaxSplits = 5;
+
+    G4String particle = "neutron";
+    G4int nLayers = 0;
+    G4double zMin = 0.;
+    G4double zMax = 0.;
+    std::vector<G4double> upperEnergies;  // 升序能群上界
+    std::vector<G4double> lowerWeights;   // [cell * nGroups + group]
+
+    G4int NumberOfCells() const { return nLayers + 2; }
+    G4int NumberOfGroups() const { return static_cast<G4int>(upperEnergies.size()); }
+
+    // z在玻璃前为0，玻璃内为1..N，玻璃后为N+1
+    G4int CellIndex(G4double z) const;
+    G4int GroupIndex(G4double energy) const;
+
+    std::vector<G4double> CellLowerWeights(G4int cell) const;
+
+    G4bool Load(const G4String& path);
+    G4bool Save(const G4String& path) const;
+
+    // 由 NGAMMA_WW_EBOUNDS（逗号分隔，MeV）读取能群上界，缺省为中子输运常用的9群
+    static std::vector<G4double> EnergyBoundsFromEnvironment();
+};
+
+}  // namespace B1
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
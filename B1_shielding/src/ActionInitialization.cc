@@ -54,7 +54,8 @@ ActionInitialization::~ActionInitialization()
 void ActionInitialization::BuildForMaster() const
 {
   G4cout << "ActionInitialization::BuildForMaster() called" << G4endl;
-  SetUserAction(new RunAction());
+  // master不产生事件，但需要一个源实例接收 /source/、/gps/ 命令，以便在run开始时给出源标签
+  SetUserAction(new RunAction(new PrimaryGeneratorAction()));
   G4cout << "RunAction set for master thread" << G4endl;
 }
 
@@ -0,0 +1,268 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/ConvergenceMonitor.cc
+/// \brief Implementation of the B1::ConvergenceMonitor class
+
+#include "ConvergenceMonitor.hh"
+
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace B1
+{
+
+namespace {
+  G4Mutex convergenceMutex = G4MUTEX_INITIALIZER;
+  const char* kTallyNames[ConvergenceMonitor::kNumTallies] = {"gamma", "neutron", "capture", "dpa", "edep", "niel"};
+  const char* kTallyTitles[ConvergenceMonitor::kNumTallies] = {
+    "Gamma_Transmit_E integral", "Neutron_Transmit_E integral", "Capture_Count", "total DPA", "Edep [MeV]",
+    "NIEL [MeV]"};
+}
+
+TallyStatistics ConvergenceMonitor::fGlobal{"ConvergenceGlobal", ConvergenceMonitor::kNumTallies};
+G4double ConvergenceMonitor::fGlobalEvents = 0.;
+std::atomic<G4bool> ConvergenceMonitor::fStopRequested{false};
+std::atomic<G4int> ConvergenceMonitor::fStopReason{0};
+std::clock_t ConvergenceMonitor::fCpuStart = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* ConvergenceMonitor::TallyName(G4int tally)
+{
+  return (tally >= 0 && tally < kNumTallies) ? kTallyNames[tally] : "unknown";
+}
+
+const char* ConvergenceMonitor::TallyTitle(G4int tally)
+{
+  return (tally >= 0 && tally < kNumTallies) ? kTallyTitles[tally] : "unknown";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ConvergenceMonitor::ConvergenceMonitor()
+{
+  fMessenger = new G4GenericMessenger(this, "/scoring/convergence/", "Stop the run on statistical convergence");
+  fMessenger->DeclareMethod("target", &ConvergenceMonitor::SetTarget)
+            .SetGuidance("target <tally> <R>: stop once the per-history relative error of <tally> is <= R")
+            .SetGuidance("tally = gamma | neutron (transmitted weight), capture, dpa, edep, niel; R = 0 removes it")
+            .SetGuidance("All targets must be met (and VOV <= maxVOV) at the same check");
+  fMessenger->DeclareMethod("clear", &ConvergenceMonitor::ClearTargets)
+            .SetGuidance("Remove all targets and the CPU budget (fixed-length runs)");
+  fMessenger->DeclareProperty("maxVOV", fMaxVOV)
+            .SetGuidance("Upper limit on the variance of the variance for a target to count as met (default 0.1)");
+  fMessenger->DeclareProperty("minEvents", fMinEvents)
+            .SetGuidance("Never stop on convergence before this many events (default 10000)")
+            .SetRange("minEvents>=0");
+  fMessenger->DeclareProperty("checkInterval", fCheckInterval)
+            .SetGuidance("Events per thread between merges/checks of the shared statistics (default 1000)")
+            .SetRange("checkInterval>=1");
+  fMessenger->DeclarePropertyWithUnit("cpuBudget", "s", fCpuBudget)
+            .SetGuidance("Stop once the process CPU time of this run exceeds the budget (all threads); 0 = none");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ConvergenceMonitor::~ConvergenceMonitor()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::SetTarget(const G4String& args)
+{
+  std::istringstream iss(args);
+  G4String name;
+  G4double target = 0.;
+  if (!(iss >> name >> target)) {
+    G4cerr << "WARNING: /scoring/convergence/target expects <tally> <relative error>" << G4endl;
+    return;
+  }
+  for (G4int t = 0; t < kNumTallies; ++t) {
+    if (name == kTallyNames[t]) {
+      fTargetR[t] = std::max(target, 0.);
+      return;
+    }
+  }
+  G4cerr << "WARNING: /scoring/convergence/target: unknown tally " << name
+         << " (gamma, neutron, capture, dpa, edep, niel)" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::ClearTargets()
+{
+  fTargetR.fill(0.);
+  fCpuBudget = 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ConvergenceMonitor::IsActive() const
+{
+  if (fCpuBudget > 0.) return true;
+  for (G4double target : fTargetR) {
+    if (target > 0.) return true;
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double ConvergenceMonitor::CpuSeconds()
+{
+  return static_cast<G4double>(std::clock() - fCpuStart) / CLOCKS_PER_SEC;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::BeginOfRun(G4bool isMaster)
+{
+  // 本线程的 TallyStatistics 已由累积量管理器在同一BeginOfRunAction中清零
+  fFlushed.Reset();
+  fLocalEvents = 0;
+  // master的BeginOfRun先于worker的事件循环
+  if (isMaster) {
+    G4AutoLock lock(&convergenceMutex);
+    fGlobal.Reset();
+    fGlobalEvents = 0.;
+    fStopRequested = false;
+    fStopReason = 0;
+    fCpuStart = std::clock();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::EndOfEvent(const TallyStatistics& stats)
+{
+  ++fLocalEvents;
+
+  if (!IsActive()) return;
+
+  if (fLocalEvents >= fCheckInterval && !fStopRequested) {
+    G4AutoLock lock(&convergenceMutex);
+    FlushLocal(stats);
+    if (!fStopRequested && CheckConverged()) {
+      fStopRequested = true;
+      G4cout << "[convergence] stop after " << static_cast<long long>(fGlobalEvents) << " events: "
+             << (fStopReason == 1 ? "targets met" : "CPU budget exhausted") << G4endl;
+    }
+  }
+  // 软中止：当前事件已完整计分，后续事件不再处理
+  if (fStopRequested) G4RunManager::GetRunManager()->AbortRun(true);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::FlushLocal(const TallyStatistics& stats)
+{
+  fGlobal.AddDifference(stats, fFlushed);
+  fFlushed.CopySums(stats);
+  fGlobalEvents += fLocalEvents;
+  fLocalEvents = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ConvergenceMonitor::CheckConverged() const
+{
+  if (fCpuBudget > 0. && CpuSeconds() >= fCpuBudget / s) {
+    fStopReason = 2;
+    return true;
+  }
+  if (fGlobalEvents < fMinEvents) return false;
+
+  G4bool anyTarget = false;
+  for (G4int t = 0; t < kNumTallies; ++t) {
+    if (fTargetR[t] <= 0.) continue;
+    anyTarget = true;
+    G4double r = fGlobal.RelativeError(t, fGlobalEvents);
+    // 尚无计分（R = 0）不算收敛
+    if (r <= 0. || r > fTargetR[t]) return false;
+    if (fGlobal.VarianceOfVariance(t, fGlobalEvents) > fMaxVOV) return false;
+  }
+  if (anyTarget) fStopReason = 1;
+  return anyTarget;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* ConvergenceMonitor::StopReason()
+{
+  return (fStopReason == 1) ? "converged" : (fStopReason == 2) ? "cpu_budget" : "beamOn_limit";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ConvergenceMonitor::Report(const G4String& outputDir, const TallyStatistics& stats, G4double nEvents,
+                                G4double cpu) const
+{
+  if (!IsActive()) return;
+
+  const G4double minutes = cpu / 60.;
+  const char* reason = StopReason();
+
+  std::ofstream fout((std::filesystem::path(outputDir) / "convergence.txt").string());
+  if (fout.good()) {
+    fout << "# stop = " << reason << "; events = " << static_cast<long long>(nEvents)
+         << "; cpu_s = " << cpu << "\n";
+    fout << "# tally mean_per_history rel_err vov fom_per_min target\n";
+  }
+
+  G4cout << G4endl << "--------------------Convergence (" << reason << ")--------------------" << G4endl;
+  for (G4int t = 0; t < kNumTallies; ++t) {
+    G4double mean = stats.Mean(t, nEvents);
+    G4double r = stats.RelativeError(t, nEvents);
+    G4double vov = stats.VarianceOfVariance(t, nEvents);
+    G4double fom = (r > 0. && minutes > 0.) ? 1. / (r * r * minutes) : 0.;
+    G4cout << " " << std::setw(28) << std::left << kTallyTitles[t] << std::right
+           << " mean = " << std::setprecision(5) << mean << "  R = " << r
+           << "  VOV = " << vov << "  FOM = " << fom;
+    if (fTargetR[t] > 0.) G4cout << "  (target R <= " << fTargetR[t] << ")";
+    G4cout << G4endl;
+    if (fout.good()) {
+      fout << kTallyNames[t] << " " << std::scientific << mean << " " << r << " "
+           << vov << " " << fom << std::defaultfloat << " " << fTargetR[t] << "\n";
+    }
+  }
+  G4cout << " CPU time " << cpu << " s" << G4endl;
+  G4cout << "----------------------------------------------------------" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
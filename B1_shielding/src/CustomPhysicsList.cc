@@ -25,6 +25,21 @@
 #include "G4EmExtraPhysics.hh"
 #include "G4EmParameters.hh"
 #include "G4StoppingPhysics.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4Version.hh"
+#include "G4Threading.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "HashUtil.hh"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
 #include "G4IonPhysics.hh"
 #include "G4IonElasticPhysics.hh"
 
@@ -150,4 +165,114 @@ void CustomPhysicsList::SetCuts()
   SetCutValue(cutForProton, "proton");
 
   if (verboseLevel>0) DumpCutValuesTable();
+
+  // 几何（材料与区域cut）此时已构建，可以确定缓存键。物理列表对象为各线程共享，
+  // 只由master配置缓存（worker直接使用master构建或读取的物理表）
+  if (G4Threading::IsMasterThread()) ConfigureTableCache();
+}
+
+G4String CustomPhysicsList::ComputeTableCacheKey() const
+{
+  std::ostringstream sig;
+  sig.precision(12);
+  sig << "g4 " << G4VERSION_NUMBER << " em " << fEMPhysicsOption;
+  sig << " cuts " << defaultCutValue << " " << cutForGamma << " " << cutForElectron
+      << " " << cutForPositron << " " << cutForProton;
+
+  const G4EmParameters* em = G4EmParameters::Instance();
+  sig << " embins " << em->NumberOfBinsPerDecade() << " " << em->MinKinEnergy() << " " << em->MaxKinEnergy();
+
+  for (const G4Region* region : *G4RegionStore::GetInstance()) {
+    sig << " region " << region->GetName();
+    if (const G4ProductionCuts* cuts = region->GetProductionCuts()) {
+      for (const auto& v : cuts->GetProductionCuts()) sig << " " << v;
+    }
+  }
+
+  // 只取几何中实际使用的材料（物理表按材料-cut对建立）：服务模式下材料表里
+  // 累积的旧配方不影响键，换配方后键随之改变
+  std::set<const G4Material*> used;
+  for (const G4LogicalVolume* volume : *G4LogicalVolumeStore::GetInstance()) {
+    if (volume->GetMaterial()) used.insert(volume->GetMaterial());
+  }
+  for (const G4Material* material : *G4Material::GetMaterialTable()) {
+    if (used.count(material) == 0) continue;
+    sig << " mat " << material->GetName() << " " << material->GetDensity();
+    const G4ElementVector* elements = material->GetElementVector();
+    const G4double* fractions = material->GetFractionVector();
+    for (std::size_t i = 0; i < material->GetNumberOfElements(); ++i) {
+      sig << " " << (*elements)[i]->GetZasInt() << ":" << fractions[i];
+    }
+  }
+  return B1::HashToHex(B1::Fnv1a64(sig.str()));
+}
+
+void CustomPhysicsList::ConfigureTableCache()
+{
+  fTableCacheDir.clear();
+  const char* envCache = std::getenv("NGAMMA_CACHE_DIR");
+  const char* envPhys = std::getenv("NGAMMA_PHYS_CACHE");
+  if (!envCache || envCache[0] == '\0') return;
+  if (envPhys && std::string(envPhys) == "0") return;
+
+  fTableCacheKey = ComputeTableCacheKey();
+  std::filesystem::path dir = std::filesystem::path(envCache) / "phys" / std::string(fTableCacheKey);
+  fTableCacheDir = dir.string();
+
+  // 只有写入完整（带complete标记）的缓存才读取；读取失败时Geant4会回退为重新构建
+  if (std::filesystem::exists(dir / "complete")) {
+    SetPhysicsTableRetrieved(fTableCacheDir);
+    fTablesRetrieved = true;
+    G4cout << "Physics tables: retrieving from cache " << fTableCacheDir << G4endl;
+  }
+  else {
+    G4cout << "Physics tables: no cache for key " << fTableCacheKey
+           << ", tables will be stored after the first build" << G4endl;
+  }
+}
+
+void CustomPhysicsList::ResetTableCache()
+{
+  if (!G4Threading::IsMasterThread()) return;
+  fTablesRetrieved = false;
+  fTablesStored = false;
+  ResetPhysicsTableRetrieved();
+  ConfigureTableCache();
+}
+
+void CustomPhysicsList::StorePhysicsTablesIfNeeded()
+{
+  if (fTableCacheDir.empty() || fTablesRetrieved || fTablesStored) return;
+  fTablesStored = true;
+
+  // 每个run复查键：材料若经ResetTableCache以外的途径改变，不能把新表写到旧键下
+  if (ComputeTableCacheKey() != fTableCacheKey) {
+    G4cerr << "WARNING: materials changed since the physics table cache was configured; "
+           << "tables not stored" << G4endl;
+    return;
+  }
+
+  // 先写到临时目录再改名，并发进程不会读到写了一半的缓存
+  std::filesystem::path finalDir(std::string(fTableCacheDir));
+  std::filesystem::path tmpDir = finalDir;
+  tmpDir += B1::TempSuffix();
+  std::error_code ec;
+  std::filesystem::create_directories(tmpDir, ec);
+  if (ec) {
+    G4cerr << "WARNING: cannot create physics table cache " << tmpDir.string() << G4endl;
+    return;
+  }
+  if (!StorePhysicsTable(tmpDir.string())) {
+    G4cerr << "WARNING: failed to store physics tables to " << tmpDir.string() << G4endl;
+    std::filesystem::remove_all(tmpDir, ec);
+    return;
+  }
+  std::ofstream(tmpDir / "complete") << fTableCacheKey << "\n";
+  std::filesystem::rename(tmpDir, finalDir, ec);
+  if (ec) {
+    // 其他进程已写入同一键的缓存
+    std::filesystem::remove_all(tmpDir, ec);
+    return;
+  }
+  G4cout << "Physics tables stored to " << finalDir.string() << G4endl;
 }
\ No newline at end of file
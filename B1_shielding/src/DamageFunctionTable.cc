@@ -0,0 +1,330 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/DamageFunctionTable.cc
+/// \brief Implementation of the B1::DamageFunctionTable class
+
+#include "DamageFunctionTable.hh"
+#include "MaterialScoringTable.hh"
+#include "HashUtil.hh"
+
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4SystemOfUnits.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const G4double kEmin = 1.e-5*eV;   // 网格下限
+  const char kCacheMagic[8] = {'N','G','D','M','G','T','B','1'};
+  // 模型或网格变更时递增，使旧缓存失效
+  const G4int kModelVersion = 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DamageFunctionTable& DamageFunctionTable::Instance()
+{
+  static DamageFunctionTable instance;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DamageFunctionTable::Species DamageFunctionTable::SpeciesOf(G4int pdgCode)
+{
+  switch (pdgCode) {
+    case 2112: return kNeutron;
+    case 2212: return kProton;
+    case 22:   return kGamma;
+    default:   return kOther;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DamageFunctionTable::Build()
+{
+  fLogEmin = std::log(kEmin);
+  fInvDeltaLog = kPointsPerDecade / std::log(10.);
+
+  std::filesystem::path cacheDir;
+  if (const char* env = std::getenv("NGAMMA_CACHE_DIR")) {
+    if (env[0] != '\0') {
+      cacheDir = std::filesystem::path(env) / "damage";
+      std::error_code ec;
+      std::filesystem::create_directories(cacheDir, ec);
+      if (ec) cacheDir.clear();
+    }
+  }
+
+  const G4MaterialTable* materials = G4Material::GetMaterialTable();
+  fCurves.assign(materials->size(), std::vector<G4double>());
+  G4int nLoaded = 0;
+  const std::size_t curveSize = std::size_t(kNumSpecies) * kNumPoints * kNumColumns;
+
+  for (const G4Material* material : *materials) {
+    const MaterialScoringRecord* rec = MaterialScoringTable::Instance().Find(material);
+    if (!rec) continue;
+    std::vector<G4double>& data = fCurves[material->GetIndex()];
+
+    // 缓存键：材料组成 + 计分常数 + 网格/模型版本
+    G4String cacheFile;
+    if (!cacheDir.empty()) {
+      std::ostringstream sig;
+      sig.precision(17);
+      sig << "v" << kModelVersion << " n" << kNumPoints << " emin" << kEmin
+          << " rho" << rec->density << " A" << rec->meanA << " Z" << rec->meanZ
+          << " N" << rec->atomDensity << " nrt" << rec->nrtEd << " srim" << rec->srimEd;
+      const G4ElementVector* elements = material->GetElementVector();
+      const G4double* fractions = material->GetFractionVector();
+      for (std::size_t i = 0; i < material->GetNumberOfElements(); ++i) {
+        sig << " " << (*elements)[i]->GetZasInt() << ":" << fractions[i];
+      }
+      cacheFile = (cacheDir / ("damage_" + HashToHex(Fnv1a64(sig.str())) + ".bin")).string();
+      if (LoadCache(cacheFile, data) && data.size() == curveSize) {
+        ++nLoaded;
+        continue;
+      }
+    }
+
+    data.assign(curveSize, 0.);
+    for (G4int s = 0; s < kNumSpecies; ++s) {
+      for (G4int i = 0; i < kNumPoints; ++i) {
+        G4double energy = std::exp(fLogEmin + i / fInvDeltaLog);
+        G4double* row = &data[(std::size_t(s) * kNumPoints + i) * kNumColumns];
+        EvaluateRow(static_cast<Species>(s), energy, *rec, row);
+      }
+    }
+    if (!cacheFile.empty()) SaveCache(cacheFile, data);
+  }
+
+  G4cout << "DamageFunctionTable: " << materials->size() << " materials x "
+         << kNumSpecies << " species, " << kNumPoints << " log-energy points"
+         << " (" << nLoaded << " loaded from cache)" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DamageFunctionTable::Lookup(std::size_t materialIndex, Species species,
+                                   G4double energy, Cursor& cursor) const
+{
+  if (materialIndex >= fCurves.size() || fCurves[materialIndex].empty()) return false;
+
+  // 网格外的能量取端点值
+  G4double x = (energy > kEmin) ? (std::log(energy) - fLogEmin) * fInvDeltaLog : 0.;
+  G4int i = static_cast<G4int>(x);
+  G4double t = x - i;
+  if (i >= kNumPoints - 1) { i = kNumPoints - 2; t = 1.; }
+
+  const G4double* base = fCurves[materialIndex].data()
+                         + (std::size_t(species) * kNumPoints + i) * kNumColumns;
+  cursor.lo = base;
+  cursor.hi = base + kNumColumns;
+  cursor.t = t;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DamageFunctionTable::EvaluateRow(Species species, G4double energy,
+                                      const MaterialScoringRecord& rec, G4double* row)
+{
+  const G4double T = RecoilEnergy(energy, species, rec.meanA);
+  const G4double Sn = NuclearStoppingPower(energy, species);
+  const G4double Se = ElectronicStoppingPower(energy, species);
+  const G4double N = rec.atomDensity;
+
+  row[kRecoilEnergy] = T;
+  row[kNuclearStopping] = Sn;
+  row[kElectronicStopping] = Se;
+
+  // NRT：ν(T) = 0.8T/(2Ed)，dpa = ν·edep/(2·Ed·N·V)，V = stepLength × 1 cm2
+  const G4double EdNRT = rec.nrtEd;
+  row[kNRTFactor] = 0.8 * T / (2.0 * EdNRT) / (2.0 * EdNRT * N * 1.*cm2);
+
+  // SRIM：dpa = (Sn + 0.1·Se)·stepLength/(2·Ed·N)，电子阻止本领贡献取10%
+  const G4double EdSRIM = rec.srimEd;
+  row[kSRIMPerLength] = (Sn + 0.1 * Se) / (2.0 * EdSRIM * N);
+
+  // NIEL：带电粒子用核阻止本领近似；中子PKA经Lindhard分配；γ给极小近似
+  row[kNIELPerLength] = 0.;
+  row[kNIELPerStep] = 0.;
+  if (species == kNeutron) {
+    // 取等效反冲能量（与DPA中同一近似保持一致），平均A用于近似计算
+    const G4double Trec = RecoilEnergy(energy, species, rec.nielA);
+    if (Trec > 0.) row[kNIELPerStep] = LindhardFraction(Trec) * Trec;
+  }
+  else if (species == kGamma) {
+    row[kNIELPerLength] = 1.0e-4 * MeV / mm;
+  }
+  else {
+    row[kNIELPerLength] = Sn * rec.density;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 计算反冲能量
+G4double DamageFunctionTable::RecoilEnergy(G4double kineticEnergy, Species species, G4double atomicWeight)
+{
+  G4double T = 0.;
+
+  if (species == kNeutron || species == kProton) {
+    // 中子/质子-核弹性散射的最大能量传递
+    T = 4.0 * kineticEnergy * atomicWeight /
+        ((1.0 + atomicWeight) * (1.0 + atomicWeight));
+  } else if (species == kGamma) {
+    // γ射线通过光电效应和康普顿散射
+    T = kineticEnergy * 0.1;  // 约10%能量传递给反冲电子
+  } else {
+    // 其他粒子
+    T = kineticEnergy * 0.5;
+  }
+
+  return T;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 计算核阻止本领
+G4double DamageFunctionTable::NuclearStoppingPower(G4double energy, Species species)
+{
+  G4double stoppingPower = 0.;
+
+  if (species == kNeutron) {
+    // 中子核阻止本领（基于能量）
+    if (energy < 1.*keV) {
+      stoppingPower = 1.0e-3 * MeV / (g/cm2);  // 热中子
+    } else if (energy < 1.*MeV) {
+      stoppingPower = 1.0e-2 * MeV / (g/cm2);  // 快中子
+    } else {
+      stoppingPower = 1.0e-1 * MeV / (g/cm2);  // 高能中子
+    }
+  } else if (species == kProton) {
+    // 质子核阻止本领（基于Bethe-Bloch公式简化）
+    stoppingPower = 0.1 * MeV / (g/cm2) * std::log(energy / (1.*MeV));
+  } else if (species == kGamma) {
+    // γ射线通过次级电子产生核阻止
+    stoppingPower = 1.0e-4 * MeV / (g/cm2);
+  } else {
+    // 其他粒子
+    stoppingPower = 1.0e-2 * MeV / (g/cm2);
+  }
+
+  return stoppingPower;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 计算电子阻止本领
+G4double DamageFunctionTable::ElectronicStoppingPower(G4double energy, Species species)
+{
+  G4double stoppingPower = 0.;
+
+  if (species == kNeutron) {
+    // 中子电子阻止本领（较小）
+    stoppingPower = 1.0e-4 * MeV / (g/cm2);
+  } else if (species == kProton) {
+    // 质子电子阻止本领（基于Bethe-Bloch公式）
+    stoppingPower = 1.0 * MeV / (g/cm2) * std::log(energy / (1.*MeV));
+  } else if (species == kGamma) {
+    // γ射线电子阻止本领
+    stoppingPower = 1.0e-2 * MeV / (g/cm2);
+  } else {
+    // 其他粒子
+    stoppingPower = 1.0e-1 * MeV / (g/cm2);
+  }
+
+  return stoppingPower;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 简化的Lindhard分配函数（常用近似：k*g(e)形式，这里用单调近似）
+G4double DamageFunctionTable::LindhardFraction(G4double T)
+{
+  // 归一化能量尺度和经验系数（为保持稳定性取常见近似）
+  // f_L(T) ~ c * T^(m) / (1 + b*T^(m))，保证0..1范围
+  const G4double c = 0.3;
+  const G4double b = 0.1 / MeV;
+  const G4double m = 0.5; // 次方根形状
+  G4double x = std::pow(std::max(T, 0.*MeV)/MeV, m);
+  G4double f = (c * x) / (1.0 + b * x);
+  if (f < 0.) f = 0.;
+  if (f > 1.) f = 1.;
+  return f;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DamageFunctionTable::LoadCache(const G4String& path, std::vector<G4double>& data) const
+{
+  std::ifstream fin(path, std::ios::binary);
+  if (!fin.good()) return false;
+  char magic[8];
+  std::uint64_t count = 0;
+  fin.read(magic, sizeof(magic));
+  fin.read(reinterpret_cast<char*>(&count), sizeof(count));
+  if (!fin || std::memcmp(magic, kCacheMagic, sizeof(magic)) != 0) return false;
+  data.resize(count);
+  fin.read(reinterpret_cast<char*>(data.data()), std::streamsize(count * sizeof(G4double)));
+  return bool(fin);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DamageFunctionTable::SaveCache(const G4String& path, const std::vector<G4double>& data) const
+{
+  // 先写临时文件再改名，避免并发进程读到半个文件
+  G4String tmpPath = path + TempSuffix();
+  {
+    std::ofstream fout(tmpPath, std::ios::binary);
+    if (!fout.good()) return;
+    std::uint64_t count = data.size();
+    fout.write(kCacheMagic, sizeof(kCacheMagic));
+    fout.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    fout.write(reinterpret_cast<const char*>(data.data()), std::streamsize(count * sizeof(G4double)));
+    if (!fout) return;
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmpPath.c_str(), path.c_str(), ec);
+  if (ec) std::filesystem::remove(tmpPath.c_str(), ec);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
@@ -0,0 +1,247 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/DepthTransmissionScorer.cc
+/// \brief Implementation of the B1::DepthTransmissionScorer class
+
+#include "DepthTransmissionScorer.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4Step.hh"
+#include "G4GeometryTolerance.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4AnalysisManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4UIcommand.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace B1
+{
+
+namespace {
+  const char* kParticleNames[DepthTransmissionScorer::kNumParticles] = {"neutron", "gamma"};
+  // 能谱上限与 Neutron_/Gamma_Transmit_E 一致
+  const G4double kEmaxMeV[DepthTransmissionScorer::kNumParticles] = {20., 10.};
+  // 直方图编号：H2紧接注量的H2 0/1，H1紧接RunAction中的前10个H1
+  const G4int kDepthH2[DepthTransmissionScorer::kNumParticles] = {2, 3};
+  const G4int kPlaneDepthH1 = 10;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DepthTransmissionScorer::DepthTransmissionScorer()
+  : fStatistics("DepthTransmission", static_cast<std::size_t>(kMaxPlanes) * kNumParticles * (kNumEnergyBins + 1))
+{
+  fMessenger = new G4GenericMessenger(this, "/scoring/depth/", "Depth-resolved transmission planes in the glass");
+  fMessenger->DeclareMethod("planes", &DepthTransmissionScorer::SetUniformPlanes)
+            .SetGuidance("Split the glass thickness into K equal slices and score forward crossings")
+            .SetGuidance("at every slice boundary (depths t/K, 2t/K, ..., t); 0 disables");
+  fMessenger->DeclareMethod("addPlane", &DepthTransmissionScorer::AddPlane)
+            .SetGuidance("Add a scoring plane at <depth> [unit=mm] measured from the upstream glass face");
+  fMessenger->DeclareMethod("clearPlanes", &DepthTransmissionScorer::ClearPlanes)
+            .SetGuidance("Remove all depth planes (scoring off)");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DepthTransmissionScorer::~DepthTransmissionScorer()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DepthTransmissionScorer::Book()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  analysisManager->CreateH2("Neutron_Depth_Transmit_E", "Neutron forward crossings per primary vs depth plane",
+                            kMaxPlanes, 0., kMaxPlanes,
+                            kNumEnergyBins, 0., kEmaxMeV[0]*MeV);
+  analysisManager->CreateH2("Gamma_Depth_Transmit_E", "Gamma forward crossings per primary vs depth plane",
+                            kMaxPlanes, 0., kMaxPlanes,
+                            kNumEnergyBins, 0., kEmaxMeV[1]*MeV);
+  analysisManager->CreateH1("Depth_Plane_mm", "Depth of each transmission plane [mm]",
+                            kMaxPlanes, 0., kMaxPlanes);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DepthTransmissionScorer::SetUniformPlanes(G4int nPlanes)
+{
+  if (nPlanes >= kMaxPlanes) {
+    G4cerr << "WARNING: at most " << kMaxPlanes - 1 << " depth planes" << G4endl;
+    nPlanes = kMaxPlanes - 1;
+  }
+  fUniformPlanes = std::max(nPlanes, 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DepthTransmissionScorer::AddPlane(const G4String& args)
+{
+  std::istringstream iss(args);
+  G4double depth = 0.;
+  G4String unit = "mm";
+  if (!(iss >> depth)) {
+    G4cerr << "WARNING: /scoring/depth/addPlane expects <depth> [unit]" << G4endl;
+    return;
+  }
+  iss >> unit;
+  if (depth <= 0.) return;
+  fDepthSpecs.push_back(depth * G4UIcommand::ValueOf(unit));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DepthTransmissionScorer::BeginOfRun(const DetectorConstruction* detector)
+{
+  const G4double thickness = detector->GetGlassSizeZ();
+  const G4double zFront = -0.5 * thickness;  // 玻璃放置于原点，束流沿 +z
+  fZBack = 0.5 * thickness;
+  fScoringVolume = detector->GetScoringVolume();
+
+  std::vector<G4double> depths;
+  for (G4int i = 1; i <= fUniformPlanes; ++i) depths.push_back(thickness * i / fUniformPlanes);
+  for (G4double depth : fDepthSpecs) {
+    if (depth <= thickness) depths.push_back(depth);
+  }
+  std::sort(depths.begin(), depths.end());
+  depths.erase(std::unique(depths.begin(), depths.end(),
+                           [](G4double a, G4double b) { return std::abs(a - b) < 1.e-6*mm; }),
+               depths.end());
+  if (static_cast<G4int>(depths.size()) >= kMaxPlanes) {
+    G4cerr << "WARNING: depth planes truncated to " << kMaxPlanes - 1 << G4endl;
+    depths.resize(kMaxPlanes - 1);
+  }
+
+  fPlaneDepth.clear();
+  fPlaneZ.clear();
+  if (depths.empty()) return;
+  fPlaneDepth.push_back(0.);
+  fPlaneDepth.insert(fPlaneDepth.end(), depths.begin(), depths.end());
+  for (G4double depth : fPlaneDepth) fPlaneZ.push_back(zFront + depth);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t DepthTransmissionScorer::BinIndex(G4int plane, G4int particle, G4int energyBin) const
+{
+  return (static_cast<std::size_t>(plane) * kNumParticles + particle) * (kNumEnergyBins + 1) + energyBin;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DepthTransmissionScorer::Score(const G4Step* step, G4double weight)
+{
+  if (!IsActive()) return;
+
+  G4int pdg = step->GetTrack()->GetDefinition()->GetPDGEncoding();
+  G4int particle = (pdg == 2112) ? 0 : (pdg == 22) ? 1 : -1;
+  if (particle < 0) return;
+
+  // 只在玻璃内计分（世界体积中玻璃侧面以外的步不计）
+  if (step->GetPreStepPoint()->GetTouchableHandle()->GetVolume()->GetLogicalVolume() != fScoringVolume) return;
+
+  // 只计向 +z 的穿越
+  const G4double z1 = step->GetPreStepPoint()->GetPosition().z();
+  const G4double z2 = step->GetPostStepPoint()->GetPosition().z();
+  if (z2 <= z1) return;
+
+  // 步前能量（中性粒子在穿越点之前能量不变），超出上限的只计入总量箱
+  G4double energy = step->GetPreStepPoint()->GetKineticEnergy() / MeV;
+  G4int energyBin = (energy < kEmaxMeV[particle])
+                      ? std::min(static_cast<G4int>(energy / kEmaxMeV[particle] * kNumEnergyBins), kNumEnergyBins - 1)
+                      : -1;
+
+  // 平面升序：找出落在 (z1, z2] 内的平面。半开区间保证止于平面上的步与从该平面出发的
+  // 下一步只计一次；玻璃外的步不计，因此两个端面按容差并入：起点在上游面（入射步）
+  // 计平面0，终点在下游面计最后一个平面。
+  const G4double tolerance = G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+  auto first = (z1 <= fPlaneZ.front() + tolerance) ? fPlaneZ.begin()
+                                                    : std::upper_bound(fPlaneZ.begin(), fPlaneZ.end(), z1);
+  const G4double zLast = (z2 >= fZBack - tolerance) ? fZBack + tolerance : z2;
+  for (auto it = first; it != fPlaneZ.end() && *it <= zLast; ++it) {
+    G4int plane = static_cast<G4int>(it - fPlaneZ.begin());
+    if (energyBin >= 0) fStatistics.Score(BinIndex(plane, particle, energyBin), weight);
+    fStatistics.Score(BinIndex(plane, particle, kNumEnergyBins), weight);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DepthTransmissionScorer::Report(G4int nEvents, const G4String& outputDir) const
+{
+  if (!IsActive()) return;
+
+  const G4double n = nEvents;
+  auto analysisManager = G4AnalysisManager::Instance();
+
+  std::ofstream fout((std::filesystem::path(outputDir) / "depth_transmission.txt").string());
+  if (fout.good()) {
+    fout << "# forward crossings per primary at depth planes; plane 0 = upstream face; events = " << nEvents << "\n";
+    fout << "# plane depth_mm particle crossings rel_err transmission efficiency_percent\n";
+  }
+
+  G4cout << G4endl << "--------------------Depth transmission--------------------" << G4endl;
+  for (std::size_t p = 0; p < fPlaneDepth.size(); ++p) {
+    G4int plane = static_cast<G4int>(p);
+    analysisManager->FillH1(kPlaneDepthH1, plane + 0.5, fPlaneDepth[p] / mm);
+    G4cout << " plane " << p << " depth " << std::setprecision(4) << fPlaneDepth[p] / mm << " mm:";
+    for (G4int particle = 0; particle < kNumParticles; ++particle) {
+      std::size_t total = BinIndex(plane, particle, kNumEnergyBins);
+      G4double crossings = fStatistics.Mean(total, n);
+      G4double incident = fStatistics.Mean(BinIndex(0, particle, kNumEnergyBins), n);
+      G4double transmission = (incident > 0.) ? crossings / incident : 0.;
+      G4cout << "  " << kParticleNames[particle] << " T=" << transmission
+             << " (R=" << fStatistics.RelativeError(total, n) << ")";
+      if (fout.good()) {
+        fout << p << " " << fPlaneDepth[p] / mm << " " << kParticleNames[particle] << " "
+             << std::scientific << crossings << " " << fStatistics.RelativeError(total, n) << " "
+             << transmission << std::defaultfloat << " " << (1. - transmission) * 100. << "\n";
+      }
+      for (G4int e = 0; e < kNumEnergyBins; ++e) {
+        G4double mean = fStatistics.Mean(BinIndex(plane, particle, e), n);
+        if (mean <= 0.) continue;
+        G4double eMid = (e + 0.5) * kEmaxMeV[particle] / kNumEnergyBins;
+        analysisManager->FillH2(kDepthH2[particle], plane + 0.5, eMid * MeV, mean);
+      }
+    }
+    G4cout << G4endl;
+  }
+  G4cout << "----------------------------------------------------------" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
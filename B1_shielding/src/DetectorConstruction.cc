@@ -29,8 +29,11 @@
 
 #include "DetectorConstruction.hh"
 #include "DetectorMessenger.hh"
+#include "GlassMaterialRegistry.hh"
+#include "CustomPhysicsList.hh"
 
 #include "G4RunManager.hh"
+#include "G4RunManagerKernel.hh"
 #include "G4NistManager.hh"
 #include "G4Box.hh"
 #include "G4Cons.hh"
@@ -46,7 +49,7 @@
 #include "G4UImanager.hh"
 #include "G4Region.hh"
 #include "G4ProductionCuts.hh"
-#include <map>
+#include <fstream>
 #include <sstream>
 
 namespace B1
@@ -80,6 +83,10 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
   // 75mm厚度屏蔽玻璃体积参数
   G4double glass_sizeXY = 20 * cm;
   G4double glass_sizeZ = 7.5 * cm;  // 75mm厚度
+  fWorldSizeXY = world_sizeXY;
+  fWorldSizeZ = world_sizeZ;
+  fGlassSizeXY = glass_sizeXY;
+  fGlassSizeZ = glass_sizeZ;
 
   // Option to switch on/off checking of volumes overlaps
   G4bool checkOverlaps = true;
@@ -161,151 +168,60 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4bool DetectorConstruction::SetGlassCompositionFile(const G4String& path)
+{
+  // 先完整解析配方：文件缺失、格式错误或未知组分时保留当前玻璃并报告失败，
+  // 不能让无人值守的队列把内置玻璃的结果记在这个配方名下
+  G4String error;
+  G4Material* glass = GlassMaterialRegistry::Instance().GetGlassFromFile(path, &error);
+  if (!glass) {
+    G4ExceptionDescription ed;
+    ed << "[GlassRecipe] Cannot load recipe " << path << ": " << error
+       << "\nThe glass material is left unchanged.";
+    G4Exception("DetectorConstruction::SetGlassCompositionFile", "GlassRecipe001",
+                JustWarning, ed);
+    return false;
+  }
+  fGlassCompositionFile = path;
+  if (!fScoringVolume) return true;  // 尚未Construct：由Construct使用（已缓存的）配方玻璃
+
+  // run之间换配方（批处理服务模式）：几何不重建，只替换玻璃逻辑体的材料，
+  // 再标记物理已修改，下一次beamOn只重建材料-cut对与材料相关的物理表；
+  // worker在下一次run开始时从master同步逻辑体的材料
+  if (glass == fScoringVolume->GetMaterial()) return true;
+  fScoringVolume->SetMaterial(glass);
+  G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+  // 物理表磁盘缓存按新材料重算键：不能读取为旧玻璃构建的表
+  if (auto physList = dynamic_cast<CustomPhysicsList*>(
+        G4RunManagerKernel::GetRunManagerKernel()->GetPhysicsList())) {
+    physList->ResetTableCache();
+  }
+  G4cout << "[GlassRecipe] ShieldingGlass material replaced by " << glass->GetName()
+         << " from " << fGlassCompositionFile << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 G4Material* DetectorConstruction::DefineShieldingGlass()
 {
-  G4NistManager* nist = G4NistManager::Instance();
+  // 未指定配方文件时使用内置材料
+  if (fGlassCompositionFile.empty()) {
+    return G4NistManager::Instance()->FindOrBuildMaterial("G4_GLASS_PLATE");
+  }
 
-  // 定义元素
-  G4String name, symbol;
-  G4double a, z;
-
-  // 基础元素定义
-  a = 16.00*g/mole;
-  G4Element* elO  = new G4Element(name="Oxygen"  ,symbol="O" , z= 8., a);
-  a = 28.09*g/mole;
-  G4Element* elSi = new G4Element(name="Silicon", symbol="Si", z=14., a);
-  a = 22.99*g/mole;
-  G4Element* elNa = new G4Element(name="Sodium", symbol="Na", z=11., a);
-  a = 30.10*g/mole;
-  G4Element* elK = new G4Element(name="Potassium", symbol="K", z=19., a);
-  a = 6.941*g/mole;
-  G4Element* elLi = new G4Element(name="Lithium", symbol="Li", z=3., a);
-  a = 65.39*g/mole;
-  G4Element* elZn = new G4Element(name="Zinc", symbol="Zn", z=30., a);
-  a = 26.98*g/mole;
-  G4Element* elAl = new G4Element(name="Aluminum", symbol="Al", z=13., a);
-  a = 140.12*g/mole;
-  G4Element* elCe = new G4Element(name="Cerium", symbol="Ce", z=58., a);
-  a = 10.81*g/mole;
-  G4Element* elB = new G4Element(name="Boron", symbol="B", z=5., a);
-  a = 207.20*g/mole;
-  G4Element* elPb = new G4Element(name="Lead",symbol="Pb", z=82., a);
-  a = 157.25*g/mole;
-  G4Element* elGd = new G4Element(name="Gadolinium",symbol="Gd", z=64., a);
-  a = 24.31*g/mole;
-  G4Element* elMg = new G4Element(name="Magnesium",symbol="Mg", z=12., a);
-
-  // 定义氧化物材料
-  G4double density;
-  
-  density = 2.200*g/cm3;
-  G4Material* SiO2 = new G4Material(name="sio2", density, 2);
-  SiO2->AddElement(elSi, 1);
-  SiO2->AddElement(elO , 2);
-  
-  density = 2.270*g/cm3;
-  G4Material* Na2O = new G4Material(name="na2o", density, 2);
-  Na2O->AddElement(elNa, 2);
-  Na2O->AddElement(elO , 1);
-  
-  density = 2.3*g/cm3;
-  G4Material* K2O = new G4Material(name="k2o", density, 2);
-  K2O->AddElement(elK, 2);
-  K2O->AddElement(elO , 1);
-  
-  density = 5.6*g/cm3;
-  G4Material* ZnO = new G4Material(name="zno", density, 2);
-  ZnO->AddElement(elZn, 1);
-  ZnO->AddElement(elO , 1);
-  
-  density = 7.407*g/cm3;
-  G4Material* Gd2O3 = new G4Material(name="Gd2O3", density, 2);
-  Gd2O3->AddElement(elGd, 2);
-  Gd2O3->AddElement(elO , 3);
-  
-  density = 3.970*g/cm3;
-  G4Material* Al2O3 = new G4Material(name="al2o3", density, 2);
-  Al2O3->AddElement(elAl, 2);
-  Al2O3->AddElement(elO , 3);
-  
-  density = 2.013*g/cm3;
-  G4Material* Li2O = new G4Material(name="li2o", density, 2);
-  Li2O->AddElement(elLi, 2);
-  Li2O->AddElement(elO , 1);
-  
-  density = 7.200*g/cm3;
-  G4Material* CeO2 = new G4Material(name="ceO2", density, 2);
-  CeO2->AddElement(elCe, 1);
-  CeO2->AddElement(elO , 2);
-  
-  density = 1.840*g/cm3;
-  G4Material* B2O3 = new G4Material(name="b2O3", density, 2);
-  B2O3->AddElement(elB, 2);
-  B2O3->AddElement(elO , 3);
-  
-  density = 9.530*g/cm3;
-  G4Material* PbO = new G4Material(name="pbO", density, 2);
-  PbO->AddElement(elPb, 1);
-  PbO->AddElement(elO , 1);
-
-  density = 3.58*g/cm3;
-  G4Material* MgO = new G4Material(name="mgO", density, 2);
-  MgO->AddElement(elMg, 1);
-  MgO->AddElement(elO , 1);
-
-
-  // 若指定配方文件，则解析为材料组合；否则返回内置材料
-  if (!fGlassCompositionFile.empty()) {
-    std::ifstream fin(fGlassCompositionFile);
-    if (fin.good()) {
-      std::vector<std::pair<G4Material*, G4double>> parts;
-      std::string mname; double pct;
-      
-      // 创建材料映射表（统一小写键名）
-      std::map<std::string, G4Material*> materialMap;
-      materialMap["sio2"] = SiO2;     // 正式名称
-      materialMap["quartz"] = SiO2;   // 兼容旧配方（已废弃，请使用sio2）
-      materialMap["na2o"] = Na2O;
-      materialMap["k2o"] = K2O;
-      materialMap["zno"] = ZnO;
-      materialMap["gd2o3"] = Gd2O3;
-      materialMap["al2o3"] = Al2O3;
-      materialMap["li2o"] = Li2O;
-      materialMap["ceo2"] = CeO2;
-      materialMap["b2o3"] = B2O3;
-      materialMap["pbo"] = PbO;
-      materialMap["mgo"] = MgO;
-      
-      std::string line;
-      while (std::getline(fin, line)) {
-        if (line.empty() || line[0] == '#') continue;
-        std::istringstream iss(line);
-        if (iss >> mname >> pct) {
-          // 名称统一转换为小写
-          for (auto &c : mname) c = std::tolower(c);
-          auto it = materialMap.find(mname);
-          if (it != materialMap.end()) {
-            if (pct > 0) parts.push_back({it->second, pct});
-          } else {
-            G4cerr << "[GlassRecipe] Cannot find material: " << mname << G4endl;
-            continue;
-          }
-        }
-      }
-      if (!parts.empty()) {
-        G4double density = 2.460*g/cm3; // 可按需从文件读取或计算
-        G4Material* mix = new G4Material("ShieldingGlass", density, parts.size());
-        G4double sum = 0; for (auto& p : parts) sum += p.second;
-        for (auto& p : parts) {
-          mix->AddMaterial(p.first, (p.second/sum)*100*perCent);
-        }
-        G4cout << "[GlassRecipe] Custom ShieldingGlass built from " << fGlassCompositionFile << G4endl;
-        return mix;
-      }
-    }
-    G4cerr << "[GlassRecipe] Failed to parse recipe. Fallback to G4_GLASS_PLATE\n";
+  // 元素与氧化物由登记表定义一次；相同配方复用同一个玻璃材料（及其物理表）。
+  // 配方已在 SetGlassCompositionFile 中解析成功，这里失败说明文件在此期间被改坏
+  G4String error;
+  G4Material* mix = GlassMaterialRegistry::Instance().GetGlassFromFile(fGlassCompositionFile, &error);
+  if (!mix) {
+    G4ExceptionDescription ed;
+    ed << "[GlassRecipe] Cannot load recipe " << fGlassCompositionFile << ": " << error;
+    G4Exception("DetectorConstruction::DefineShieldingGlass", "GlassRecipe002",
+                FatalException, ed);
   }
-  return nist->FindOrBuildMaterial("G4_GLASS_PLATE");
+  G4cout << "[GlassRecipe] Custom " << mix->GetName() << " from " << fGlassCompositionFile << G4endl;
+  return mix;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
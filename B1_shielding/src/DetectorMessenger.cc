@@ -17,7 +17,11 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction* det)
 
   fCompositionFileCmd = new G4UIcmdWithAString("/det/glass/compositionFile", this);
   fCompositionFileCmd->SetGuidance("Set glass composition file path (format: <MaterialName> <percent>) per line");
+  fCompositionFileCmd->SetGuidance("After /run/initialize the glass material is swapped in place (geometry is kept).");
+  fCompositionFileCmd->SetGuidance("A missing file, a parse error or an unknown oxide makes the command fail.");
   fCompositionFileCmd->SetParameterName("filepath", false);
+  fCompositionFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fCompositionFileCmd->SetToBeBroadcasted(false);  // 材料只在master替换，worker在run开始时同步
 }
 
 DetectorMessenger::~DetectorMessenger()
@@ -30,7 +34,12 @@ DetectorMessenger::~DetectorMessenger()
 void DetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
 {
   if (command == fCompositionFileCmd && fDetector) {
-    fDetector->SetGlassCompositionFile(newValue);
+    // 配方无效时命令返回失败状态：宏被中断，队列模式跳过该作业
+    if (!fDetector->SetGlassCompositionFile(newValue)) {
+      G4ExceptionDescription ed;
+      ed << "Glass recipe not applied: " << newValue;
+      command->CommandFailed(ed);
+    }
   }
 }
 
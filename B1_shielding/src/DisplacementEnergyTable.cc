@@ -0,0 +1,139 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/DisplacementEnergyTable.cc
+/// \brief Implementation of the B1::DisplacementEnergyTable class
+
+#include "DisplacementEnergyTable.hh"
+
+#include "G4NistManager.hh"
+#include "G4SystemOfUnits.hh"
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  struct BuiltinEd { G4int Z; G4double nrt_eV; G4double srim_eV; };
+
+  // 内置逐元素位移阈值（eV）：NRT与SRIM推荐值
+  const BuiltinEd kBuiltinEd[] = {
+    { 3, 10., 10.},  // Li
+    { 5, 15., 15.},  // B
+    { 8, 20., 20.},  // O
+    {11, 18., 18.},  // Na
+    {12, 25., 25.},  // Mg 典型金属
+    {13, 25., 25.},  // Al 文献常用
+    {14, 25., 25.},  // Si
+    {19, 22., 22.},  // K
+    {56, 35., 30.},  // Ba
+    {58, 40., 35.},  // Ce 稀土较高
+    {64, 40., 35.},  // Gd 稀土较高
+    {82, 40., 35.}   // Pb
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const DisplacementEnergyTable& DisplacementEnergyTable::Instance()
+{
+  // 函数内静态对象的初始化是线程安全的
+  static const DisplacementEnergyTable instance;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DisplacementEnergyTable::DisplacementEnergyTable()
+{
+  fNRT.fill(25.*eV);
+  fSRIM.fill(25.*eV);
+  fFromFile.fill(false);
+
+  std::vector<G4String> candidates;
+  if (const char* env = std::getenv("NGAMMA_SRIM_ED_FILE")) {
+    if (env[0] != '\0') candidates.push_back(env);
+  }
+  candidates.push_back("SRIM_Ed.dat");
+  candidates.push_back("../SRIM_Ed.dat");
+#ifdef NGAMMA_SOURCE_DIR
+  candidates.push_back(G4String(NGAMMA_SOURCE_DIR) + "/SRIM_Ed.dat");
+#endif
+
+  G4bool loaded = false;
+  for (const auto& path : candidates) {
+    std::ifstream probe(path);
+    if (!probe.good()) continue;
+    Load(path);
+    loaded = true;
+    break;  // 读取到第一个可用文件即停止
+  }
+  if (!loaded) G4cout << "DisplacementEnergyTable: SRIM_Ed.dat not found, using built-in values" << G4endl;
+
+  // 内置值最后写入：对内置表中的元素，其NRT/SRIM值优先于文件（与原SteppingAction一致）
+  for (const auto& entry : kBuiltinEd) {
+    fNRT[entry.Z] = entry.nrt_eV * eV;
+    fSRIM[entry.Z] = entry.srim_eV * eV;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DisplacementEnergyTable::Load(const G4String& path)
+{
+  // 文本格式 每行: <ElementSymbol|Z> <Ed_eV>
+  std::ifstream fin(path);
+  G4NistManager* nist = G4NistManager::Instance();
+  G4int nEntries = 0;
+  std::string line;
+  while (std::getline(fin, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream iss(line);
+    std::string key; double ed_eV;
+    if (!(iss >> key >> ed_eV) || ed_eV <= 0.) continue;
+    G4int Z = std::isdigit(static_cast<unsigned char>(key[0])) ? std::atoi(key.c_str())
+                                                               : nist->GetZ(key);
+    if (Z <= 0 || Z > kMaxZ) {
+      G4cerr << "DisplacementEnergyTable: unknown element '" << key << "' in " << path << G4endl;
+      continue;
+    }
+    fNRT[Z] = ed_eV * eV;
+    fSRIM[Z] = ed_eV * eV;
+    fFromFile[Z] = true;
+    ++nEntries;
+  }
+  G4cout << "DisplacementEnergyTable: loaded " << nEntries << " Ed entries from " << path << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
@@ -32,6 +32,10 @@
 #include "RunAction.hh"
 #include "G4AnalysisManager.hh"
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "ResponseMatrix.hh"
+#include "G4SystemOfUnits.hh"
 
 namespace B1
 {
@@ -42,11 +46,26 @@ EventAction::EventAction(RunAction* runAction) : fRunAction(runAction) {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::BeginOfEventAction(const G4Event*)
+void EventAction::BeginOfEventAction(const G4Event* event)
 {
+  fTrackSampler.BeginOfEvent(event->GetEventID());
   fEdep = 0.;
   fNIEL = 0.;
   fDPA = 0.;
+  fGammaTransmit = 0.;
+  fNeutronTransmit = 0.;
+  fCaptures = 0.;
+
+  // 响应矩阵：记录初级能量（事件开始时初级顶点已生成），初级权重 = 顶点权重 × 粒子权重
+  fPrimaryEnergy = 0.;
+  fPrimaryWeight = 1.;
+  if (const G4PrimaryVertex* vertex = event->GetPrimaryVertex()) {
+    if (const G4PrimaryParticle* primary = vertex->GetPrimary()) {
+      fPrimaryEnergy = primary->GetKineticEnergy();
+      fPrimaryWeight = vertex->GetWeight() * primary->GetWeight();
+      ResponseMatrix::FillPrimary(fPrimaryEnergy, fPrimaryWeight);
+    }
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -57,38 +76,99 @@ void EventAction::EndOfEventAction(const G4Event* event)
   fRunAction->AddEdep(fEdep);
   
   // 写入ROOT树
+  // 步进中累加的是加权值：除以初级权重还原为本事件的物理量，再以初级权重填充，
+  // 源偏倚（biasToSlab）下分布与期望都无偏。重要性分裂/轮盘赌时同一事件内各径迹
+  // 权重不同，逐事件分布只是近似（均值仍无偏）
+  const G4double w = (fPrimaryWeight > 0.) ? fPrimaryWeight : 1.;
+  const G4double edep = fEdep / w;
+  const G4double dpa = fDPA / w;
+  const G4double niel = fNIEL / w;
   auto analysis = G4AnalysisManager::Instance();
   if (analysis) {
     // 写入PhysicsData树
     analysis->FillNtupleIColumn(0, 0, event->GetEventID());
-    analysis->FillNtupleDColumn(0, 1, fEdep);
+    analysis->FillNtupleDColumn(0, 1, edep);
     analysis->FillNtupleDColumn(0, 2, 0.0);  // X位置（暂时设为0）
     analysis->FillNtupleDColumn(0, 3, 0.0);  // Y位置（暂时设为0）
     analysis->FillNtupleDColumn(0, 4, 0.0);  // Z位置（暂时设为0）
+    analysis->FillNtupleDColumn(0, 5, w);
     analysis->AddNtupleRow(0);
     
     // 写入Optical树（DPA和NIEL数据）
     analysis->FillNtupleIColumn(2, 0, event->GetEventID());
-    analysis->FillNtupleDColumn(2, 1, fDPA);
-    analysis->FillNtupleDColumn(2, 2, fNIEL);
+    analysis->FillNtupleDColumn(2, 1, dpa);
+    analysis->FillNtupleDColumn(2, 2, niel);
+    analysis->FillNtupleDColumn(2, 3, w);
     analysis->AddNtupleRow(2);
     
     // 写入直方图
-    analysis->FillH1(0, fEdep);  // Edep直方图
-    analysis->FillH1(1, fDPA);   // DPA直方图
-    analysis->FillH1(2, fNIEL);  // NIEL直方图
+    analysis->FillH1(0, edep, w);  // Edep直方图
+    analysis->FillH1(1, dpa, w);   // DPA直方图
+    analysis->FillH1(2, niel, w);  // NIEL直方图
   }
+
+  // 本事件抽中的轨迹步（预算不足时整个事件跳过）
+  for (const auto& rec : fTrackSampler.EndOfEvent()) {
+    fRunAction->FillTrackData(event->GetEventID(), rec);
+  }
+
+  // 径迹长度注量：本事件贡献计入按事件统计
+  fRunAction->GetFluenceScorer().EndOfEvent();
+  fRunAction->GetDepthScorer().EndOfEvent();
+
+  // 步进中缓冲的直方图/俘获记录按刷新间隔合并
+  fRunAction->GetScoringBuffer().EndOfEvent();
+
+  // 积分计分量的按历史统计；收敛监控放在最后：满足停止条件时在此软中止run
+  const G4double history[ConvergenceMonitor::kNumTallies] = {
+    fGammaTransmit, fNeutronTransmit, fCaptures, fDPA, fEdep / MeV, fNIEL / MeV};
+  auto& statistics = fRunAction->GetHistoryStatistics();
+  for (G4int t = 0; t < ConvergenceMonitor::kNumTallies; ++t) statistics.Score(t, history[t]);
+  statistics.EndOfHistory();
+  fRunAction->GetConvergenceMonitor().EndOfEvent(statistics);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::FillTrack(G4int trackID, G4int parentID, G4int pdgCode, 
-                             G4double x, G4double y, G4double z, 
-                             G4double kineticEnergy, G4double time, G4int stepNumber)
+void EventAction::AddTransmission(G4int pdg, G4double weight)
 {
-  if (fRunAction) {
-    fRunAction->FillTrackData(trackID, parentID, pdgCode, x, y, z, kineticEnergy, time, stepNumber);
-  }
+  if (pdg == 22) fGammaTransmit += weight;
+  else if (pdg == 2112) fNeutronTransmit += weight;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ScoringBuffer* EventAction::GetScoringBuffer() const
+{
+  return fRunAction ? &fRunAction->GetScoringBuffer() : nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WeightWindowGenerator* EventAction::GetWeightWindowGenerator() const
+{
+  return fRunAction ? fRunAction->GetWeightWindowGenerator() : nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FluenceScorer* EventAction::GetFluenceScorer() const
+{
+  return fRunAction ? &fRunAction->GetFluenceScorer() : nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DepthTransmissionScorer* EventAction::GetDepthScorer() const
+{
+  return fRunAction ? &fRunAction->GetDepthScorer() : nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceWriter* EventAction::GetPhaseSpaceWriter() const
+{
+  return fRunAction ? &fRunAction->GetPhaseSpaceWriter() : nullptr;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,231 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/FluenceScorer.cc
+/// \brief Implementation of the B1::FluenceScorer class
+
+#include "FluenceScorer.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4Step.hh"
+#include "G4AnalysisManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4UIcommand.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace B1
+{
+
+namespace {
+  const char* kParticleNames[FluenceScorer::kNumParticles] = {"neutron", "gamma"};
+  // H2编号：RunAction中最先预定义的两个H2
+  const G4int kFluenceH2[FluenceScorer::kNumParticles] = {0, 1};
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FluenceScorer::FluenceScorer()
+  : fStatistics("Fluence", static_cast<std::size_t>(kMaxRegions) * kNumParticles * (kNumEnergyBins + 1))
+{
+  fInvLogBinWidth = kNumEnergyBins / std::log10(kEmaxMeV / kEminMeV);
+
+  fMessenger = new G4GenericMessenger(this, "/scoring/fluence/", "Track-length fluence tally layers");
+  fMessenger->DeclareMethod("addLayer", &FluenceScorer::AddLayer)
+            .SetGuidance("Add a thin tally layer inside the glass: <zCenter> <thickness> [unit=mm]")
+            .SetGuidance("z is measured from the glass centre (glass spans -37.5..37.5 mm)");
+  fMessenger->DeclareMethod("clearLayers", &FluenceScorer::ClearLayers)
+            .SetGuidance("Remove all user tally layers (the whole-glass region is kept)");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FluenceScorer::~FluenceScorer()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FluenceScorer::Book()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  analysisManager->CreateH2("Neutron_Fluence", "Neutron track-length fluence per primary [cm^-2]",
+                            kMaxRegions, 0., kMaxRegions,
+                            kNumEnergyBins, kEminMeV*MeV, kEmaxMeV*MeV,
+                            "none", "MeV", "none", "none", "linear", "log");
+  analysisManager->CreateH2("Gamma_Fluence", "Gamma track-length fluence per primary [cm^-2]",
+                            kMaxRegions, 0., kMaxRegions,
+                            kNumEnergyBins, kEminMeV*MeV, kEmaxMeV*MeV,
+                            "none", "MeV", "none", "none", "linear", "log");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FluenceScorer::AddLayer(const G4String& args)
+{
+  std::istringstream iss(args);
+  G4double zCenter = 0., thickness = 0.;
+  G4String unit = "mm";
+  if (!(iss >> zCenter >> thickness)) {
+    G4cerr << "WARNING: /scoring/fluence/addLayer expects <zCenter> <thickness> [unit]" << G4endl;
+    return;
+  }
+  iss >> unit;
+  if (thickness <= 0.) return;
+  if (static_cast<G4int>(fLayerSpecs.size()) + 1 >= kMaxRegions) {
+    G4cerr << "WARNING: at most " << kMaxRegions - 1 << " fluence layers" << G4endl;
+    return;
+  }
+  G4double unitValue = G4UIcommand::ValueOf(unit);
+  fLayerSpecs.emplace_back(zCenter * unitValue, thickness * unitValue);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FluenceScorer::BeginOfRun(const DetectorConstruction* detector)
+{
+  const G4double halfZ = 0.5 * detector->GetGlassSizeZ();
+  const G4double area = detector->GetGlassSizeXY() * detector->GetGlassSizeXY();
+
+  fRegions.clear();
+  fRegions.push_back({-halfZ, halfZ, area * 2. * halfZ});
+  for (const auto& spec : fLayerSpecs) {
+    // 薄层裁剪到玻璃内
+    G4double zMin = std::max(spec.first - 0.5 * spec.second, -halfZ);
+    G4double zMax = std::min(spec.first + 0.5 * spec.second, halfZ);
+    if (zMax <= zMin) continue;
+    fRegions.push_back({zMin, zMax, area * (zMax - zMin)});
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t FluenceScorer::BinIndex(G4int region, G4int particle, G4int energyBin) const
+{
+  return (static_cast<std::size_t>(region) * kNumParticles + particle) * (kNumEnergyBins + 1) + energyBin;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FluenceScorer::Score(const G4Step* step, G4double weight)
+{
+  G4int pdg = step->GetTrack()->GetDefinition()->GetPDGEncoding();
+  G4int particle = (pdg == 2112) ? 0 : (pdg == 22) ? 1 : -1;
+  if (particle < 0) return;
+
+  const G4double length = step->GetStepLength();
+  if (length <= 0.) return;
+
+  // 能量分箱（步前能量；中性粒子沿步不变），超出范围的只计入总量箱
+  G4double energy = step->GetPreStepPoint()->GetKineticEnergy() / MeV;
+  G4int energyBin = -1;
+  if (energy >= kEminMeV && energy < kEmaxMeV) {
+    energyBin = std::min(static_cast<G4int>(std::log10(energy / kEminMeV) * fInvLogBinWidth), kNumEnergyBins - 1);
+  }
+
+  const G4double z1 = step->GetPreStepPoint()->GetPosition().z();
+  const G4double z2 = step->GetPostStepPoint()->GetPosition().z();
+  const G4double zLo = std::min(z1, z2), zHi = std::max(z1, z2);
+
+  for (std::size_t r = 0; r < fRegions.size(); ++r) {
+    const Region& region = fRegions[r];
+    // 直线段在 [zMin, zMax] 内的长度 = 总步长 × z向重叠比例
+    G4double inside;
+    if (zHi > zLo) {
+      G4double overlap = std::min(zHi, region.zMax) - std::max(zLo, region.zMin);
+      if (overlap <= 0.) continue;
+      inside = length * overlap / (zHi - zLo);
+    }
+    else {
+      if (zLo < region.zMin || zLo >= region.zMax) continue;
+      inside = length;
+    }
+    G4double fluence = weight * inside / region.volume * cm2;
+    G4int ri = static_cast<G4int>(r);
+    if (energyBin >= 0) fStatistics.Score(BinIndex(ri, particle, energyBin), fluence);
+    fStatistics.Score(BinIndex(ri, particle, kNumEnergyBins), fluence);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FluenceScorer::Report(G4int nEvents, const G4String& outputDir) const
+{
+  const G4double n = nEvents;
+  auto analysisManager = G4AnalysisManager::Instance();
+
+  G4cout << G4endl << "--------------------Track-length fluence--------------------" << G4endl;
+  for (std::size_t r = 0; r < fRegions.size(); ++r) {
+    G4cout << " region " << r << " [" << fRegions[r].zMin/mm << ", " << fRegions[r].zMax/mm << "] mm:";
+    for (G4int p = 0; p < kNumParticles; ++p) {
+      std::size_t total = BinIndex(static_cast<G4int>(r), p, kNumEnergyBins);
+      G4cout << "  " << kParticleNames[p] << " " << std::setprecision(4)
+             << fStatistics.Mean(total, n) << " cm^-2 (R=" << fStatistics.RelativeError(total, n) << ")";
+    }
+    G4cout << G4endl;
+  }
+  G4cout << "------------------------------------------------------------" << G4endl;
+
+  std::ofstream fout((std::filesystem::path(outputDir) / "fluence_tally.txt").string());
+  if (fout.good()) {
+    fout << "# track-length fluence per primary [cm^-2]; events = " << nEvents << "\n";
+    fout << "# region zmin_mm zmax_mm particle elow_MeV ehigh_MeV fluence rel_err\n";
+  }
+  const G4double logStep = std::log10(kEmaxMeV / kEminMeV) / kNumEnergyBins;
+  for (std::size_t r = 0; r < fRegions.size(); ++r) {
+    for (G4int p = 0; p < kNumParticles; ++p) {
+      for (G4int e = 0; e <= kNumEnergyBins; ++e) {
+        std::size_t bin = BinIndex(static_cast<G4int>(r), p, e);
+        G4double mean = fStatistics.Mean(bin, n);
+        if (mean <= 0.) continue;
+        G4double eLow = (e < kNumEnergyBins) ? kEminMeV * std::pow(10., e * logStep) : 0.;
+        G4double eHigh = (e < kNumEnergyBins) ? kEminMeV * std::pow(10., (e + 1) * logStep) : 0.;
+        if (fout.good()) {
+          fout << r << " " << fRegions[r].zMin/mm << " " << fRegions[r].zMax/mm << " "
+               << kParticleNames[p] << " ";
+          if (e < kNumEnergyBins) fout << std::scientific << eLow << " " << eHigh << " ";
+          else fout << "total total ";
+          fout << std::scientific << mean << " " << fStatistics.RelativeError(bin, n)
+               << std::defaultfloat << "\n";
+        }
+        if (e < kNumEnergyBins) {
+          analysisManager->FillH2(kFluenceH2[p], r + 0.5, std::sqrt(eLow * eHigh) * MeV, mean);
+        }
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
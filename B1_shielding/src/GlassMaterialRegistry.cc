@@ -0,0 +1,224 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/GlassMaterialRegistry.cc
+/// \brief Implementation of the B1::GlassMaterialRegistry class
+
+#include "GlassMaterialRegistry.hh"
+#include "HashUtil.hh"
+
+#include "G4Element.hh"
+#include "G4Material.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GlassMaterialRegistry& GlassMaterialRegistry::Instance()
+{
+  static GlassMaterialRegistry instance;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GlassMaterialRegistry::DefineOxides()
+{
+  // 基础元素定义（进程内只定义一次）
+  G4String name, symbol;
+  G4double a, z;
+
+  a = 16.00*g/mole;
+  G4Element* elO  = new G4Element(name="Oxygen"  ,symbol="O" , z= 8., a);
+  a = 28.09*g/mole;
+  G4Element* elSi = new G4Element(name="Silicon", symbol="Si", z=14., a);
+  a = 22.99*g/mole;
+  G4Element* elNa = new G4Element(name="Sodium", symbol="Na", z=11., a);
+  a = 30.10*g/mole;
+  G4Element* elK = new G4Element(name="Potassium", symbol="K", z=19., a);
+  a = 6.941*g/mole;
+  G4Element* elLi = new G4Element(name="Lithium", symbol="Li", z=3., a);
+  a = 65.39*g/mole;
+  G4Element* elZn = new G4Element(name="Zinc", symbol="Zn", z=30., a);
+  a = 26.98*g/mole;
+  G4Element* elAl = new G4Element(name="Aluminum", symbol="Al", z=13., a);
+  a = 140.12*g/mole;
+  G4Element* elCe = new G4Element(name="Cerium", symbol="Ce", z=58., a);
+  a = 10.81*g/mole;
+  G4Element* elB = new G4Element(name="Boron", symbol="B", z=5., a);
+  a = 207.20*g/mole;
+  G4Element* elPb = new G4Element(name="Lead",symbol="Pb", z=82., a);
+  a = 157.25*g/mole;
+  G4Element* elGd = new G4Element(name="Gadolinium",symbol="Gd", z=64., a);
+  a = 24.31*g/mole;
+  G4Element* elMg = new G4Element(name="Magnesium",symbol="Mg", z=12., a);
+
+  // 氧化物：材料名保持原样，登记键统一小写
+  auto oxide = [this](const G4String& oxideName, G4double density,
+                      G4Element* metal, G4int nMetal, G4Element* oxygen, G4int nOxygen) {
+    auto material = new G4Material(oxideName, density, 2);
+    material->AddElement(metal, nMetal);
+    material->AddElement(oxygen, nOxygen);
+    std::string key = oxideName;
+    for (auto& c : key) c = std::tolower(c);
+    fOxides[key] = material;
+    return material;
+  };
+
+  G4Material* SiO2 = oxide("sio2", 2.200*g/cm3, elSi, 1, elO, 2);
+  oxide("na2o", 2.270*g/cm3, elNa, 2, elO, 1);
+  oxide("k2o", 2.3*g/cm3, elK, 2, elO, 1);
+  oxide("zno", 5.6*g/cm3, elZn, 1, elO, 1);
+  oxide("Gd2O3", 7.407*g/cm3, elGd, 2, elO, 3);
+  oxide("al2o3", 3.970*g/cm3, elAl, 2, elO, 3);
+  oxide("li2o", 2.013*g/cm3, elLi, 2, elO, 1);
+  oxide("ceO2", 7.200*g/cm3, elCe, 1, elO, 2);
+  oxide("b2O3", 1.840*g/cm3, elB, 2, elO, 3);
+  oxide("pbO", 9.530*g/cm3, elPb, 1, elO, 1);
+  oxide("mgO", 3.58*g/cm3, elMg, 1, elO, 1);
+
+  fOxides["quartz"] = SiO2;  // 兼容旧配方（已废弃，请使用sio2）
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Material* GlassMaterialRegistry::FindOxide(const std::string& key)
+{
+  if (fOxides.empty()) DefineOxides();
+  auto it = fOxides.find(key);
+  return (it != fOxides.end()) ? it->second : nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t GlassMaterialRegistry::RecipeHash(const Recipe& recipe, G4double density)
+{
+  // 同名组分合并后按名称排序，使 "sio2 45 / al2o3 10" 与其任意排列、倍数得到同一哈希
+  std::map<std::string, G4double> merged;
+  G4double sum = 0.;
+  for (const auto& part : recipe) {
+    merged[part.first->GetName()] += part.second;
+    sum += part.second;
+  }
+  std::string canonical;
+  char buf[64];
+  for (const auto& [name, pct] : merged) {
+    std::snprintf(buf, sizeof(buf), "%.9f", (sum > 0.) ? pct / sum : 0.);
+    canonical += name + ":" + buf + ";";
+  }
+  std::snprintf(buf, sizeof(buf), "rho=%.6f", density / (g/cm3));
+  canonical += buf;
+  return Fnv1a64(canonical);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Material* GlassMaterialRegistry::GetGlass(const Recipe& recipe, G4double density)
+{
+  std::uint64_t hash = RecipeHash(recipe, density);
+  auto it = fGlasses.find(hash);
+  if (it != fGlasses.end()) return it->second;
+
+  std::map<G4Material*, G4double> merged;
+  G4double sum = 0.;
+  for (const auto& part : recipe) {
+    merged[part.first] += part.second;
+    sum += part.second;
+  }
+  G4String name = "ShieldingGlass_" + HashToHex(hash);
+  auto glass = new G4Material(name, density, static_cast<G4int>(merged.size()));
+  for (const auto& [oxide, pct] : merged) {
+    glass->AddMaterial(oxide, (pct/sum)*100*perCent);
+  }
+  fGlasses[hash] = glass;
+  G4cout << "[GlassRecipe] Registered " << name << " (" << merged.size() << " oxides, "
+         << fGlasses.size() << " glasses cached)" << G4endl;
+  return glass;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double GlassMaterialRegistry::GlassDensity()
+{
+  return 2.460*g/cm3;  // 可按需从文件读取或计算
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Material* GlassMaterialRegistry::GetGlassFromFile(const G4String& path, G4String* error)
+{
+  // 任何一处错误都使整个配方无效：队列/服务模式无人值守，不能静默丢掉组分或改用别的玻璃
+  auto fail = [error](const G4String& reason) -> G4Material* {
+    if (error) *error = reason;
+    return nullptr;
+  };
+
+  std::ifstream fin(path);
+  if (!fin.good()) return fail("cannot open recipe file " + path);
+
+  Recipe parts;
+  std::string line;
+  G4int lineNo = 0;
+  while (std::getline(fin, line)) {
+    ++lineNo;
+    std::istringstream iss(line);
+    std::string mname;
+    if (!(iss >> mname) || mname[0] == '#') continue;  // 空行与注释
+    // 语法与 tools/result_cache.py 的 normalized_recipe 相同：
+    // "<氧化物> <百分比>[%]"，百分号可紧跟数值或单独成词，其后只允许 # 注释
+    double pct;
+    std::string extra;
+    G4bool ok = static_cast<G4bool>(iss >> pct) && pct >= 0;
+    if (ok && iss >> extra && extra == "%") {
+      extra.clear();
+      iss >> extra;
+    }
+    if (!ok || (!extra.empty() && extra[0] != '#')) {
+      return fail(path + ":" + std::to_string(lineNo) + ": cannot parse \"" + line
+                  + "\" (expected: <oxide> <percent>)");
+    }
+    // 名称统一转换为小写
+    for (auto &c : mname) c = std::tolower(c);
+    G4Material* oxide = FindOxide(mname);
+    if (!oxide) {
+      return fail(path + ":" + std::to_string(lineNo) + ": unknown component " + mname);
+    }
+    if (pct > 0) parts.push_back({oxide, pct});
+  }
+  if (parts.empty()) return fail("no component with positive percentage in " + path);
+  return GetGlass(parts, GlassDensity());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
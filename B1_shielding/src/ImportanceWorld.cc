@@ -0,0 +1,191 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/ImportanceWorld.cc
+/// \brief Implementation of the B1::ImportanceWorld class
+
+#include "ImportanceWorld.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4PVPlacement.hh"
+#include "G4IStore.hh"
+#include "G4WeightWindowStore.hh"
+#include "G4GeometryCell.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <cstdlib>
+#include <set>
+#include <sstream>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ImportanceWorld::ImportanceWorld(const G4String& worldName,
+                                 const DetectorConstruction* detector,
+                                 const std::vector<G4double>& importances)
+  : G4VUserParallelWorld(worldName), fDetector(detector), fImportances(importances)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ImportanceWorld::Construct()
+{
+  fGhostWorld = GetWorld();
+  G4LogicalVolume* ghostLogical = fGhostWorld->GetLogicalVolume();
+
+  // 横向取世界全宽，层边界只在z方向；权窗模式按文件中的z范围分层
+  const G4double halfXY = 0.5 * fDetector->GetWorldSizeXY();
+  const G4double halfWorldZ = 0.5 * fDetector->GetWorldSizeZ();
+  G4double zMin = -0.5 * fDetector->GetGlassSizeZ();
+  G4double zMax = 0.5 * fDetector->GetGlassSizeZ();
+  G4int nLayers = static_cast<G4int>(fImportances.size());
+  if (fUseWindows) {
+    zMin = fWindows.zMin;
+    zMax = fWindows.zMax;
+    nLayers = fWindows.nLayers;
+  }
+  const G4double layerZ = (zMax - zMin) / nLayers;
+
+  fLayers.clear();
+  auto solidLayer = new G4Box("ImportanceLayer", halfXY, halfXY, 0.5 * layerZ);
+  auto logicLayer = new G4LogicalVolume(solidLayer, nullptr, "ImportanceLayer");
+  for (G4int i = 0; i < nLayers; ++i) {
+    G4double zc = zMin + (i + 0.5) * layerZ;
+    fLayers.push_back(new G4PVPlacement(nullptr, G4ThreeVector(0., 0., zc), logicLayer,
+                                        "ImportanceLayer", ghostLogical, false, i));
+  }
+
+  // 玻璃下游单独一个单元
+  fDownstream = nullptr;
+  G4double downstreamZ = halfWorldZ - zMax;
+  if (downstreamZ > 0.) {
+    auto solidDown = new G4Box("ImportanceDownstream", halfXY, halfXY, 0.5 * downstreamZ);
+    auto logicDown = new G4LogicalVolume(solidDown, nullptr, "ImportanceDownstream");
+    fDownstream = new G4PVPlacement(nullptr, G4ThreeVector(0., 0., zMax + 0.5 * downstreamZ),
+                                    logicDown, "ImportanceDownstream", ghostLogical, false, 0);
+  }
+
+  if (fUseWindows) FillWeightWindowStore();
+  else FillImportanceStore();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ImportanceWorld::FillImportanceStore() const
+{
+  G4IStore* istore = G4IStore::GetInstance(GetName());
+  istore->AddImportanceGeometryCell(1., *fGhostWorld);
+  for (std::size_t i = 0; i < fLayers.size(); ++i) {
+    istore->AddImportanceGeometryCell(fImportances[i], *fLayers[i], static_cast<G4int>(i));
+  }
+  // 下游与最后一层同重要性，透射粒子不再被轮盘赌
+  if (fDownstream) istore->AddImportanceGeometryCell(fImportances.back(), *fDownstream);
+
+  G4cout << "ImportanceWorld: " << fLayers.size() << " importance layers:";
+  for (G4double imp : fImportances) G4cout << " " << imp;
+  G4cout << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ImportanceWorld::FillWeightWindowStore() const
+{
+  G4WeightWindowStore* wwstore = G4WeightWindowStore::GetInstance(GetName());
+  std::set<G4double, std::less<G4double>> bounds(fWindows.upperEnergies.begin(),
+                                                  fWindows.upperEnergies.end());
+  wwstore->SetGeneralUpperEnergyBounds(bounds);
+
+  wwstore->AddLowerWeights(G4GeometryCell(*fGhostWorld, 0), fWindows.CellLowerWeights(0));
+  for (std::size_t i = 0; i < fLayers.size(); ++i) {
+    wwstore->AddLowerWeights(G4GeometryCell(*fLayers[i], static_cast<G4int>(i)),
+                             fWindows.CellLowerWeights(static_cast<G4int>(i) + 1));
+  }
+  if (fDownstream) {
+    wwstore->AddLowerWeights(G4GeometryCell(*fDownstream, 0),
+                             fWindows.CellLowerWeights(fWindows.nLayers + 1));
+  }
+
+  G4cout << "ImportanceWorld: weight windows for " << fWindows.particle << " on "
+         << fLayers.size() << " layers x " << fWindows.NumberOfGroups() << " energy groups" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4double> ImportanceWorld::ImportancesFromEnvironment()
+{
+  std::vector<G4double> importances;
+  const char* envLayers = std::getenv("NGAMMA_IMPORTANCE_LAYERS");
+  G4int nLayers = envLayers ? std::atoi(envLayers) : 0;
+  if (nLayers <= 0) return importances;
+
+  if (const char* envValues = std::getenv("NGAMMA_IMPORTANCE_VALUES")) {
+    std::string list(envValues);
+    for (auto& c : list) { if (c == ',') c = ' '; }
+    std::istringstream iss(list);
+    G4double value;
+    while (iss >> value) importances.push_back(value);
+  }
+  if (!importances.empty()) {
+    // 逐层数值不足时用最后一个补齐，多余的忽略
+    importances.resize(nLayers, importances.back());
+  }
+  else {
+    const char* envBase = std::getenv("NGAMMA_IMPORTANCE_BASE");
+    G4double base = envBase ? std::atof(envBase) : 2.;
+    for (G4int i = 0; i < nLayers; ++i) importances.push_back(std::pow(base, i));
+  }
+
+  for (G4double& imp : importances) {
+    if (imp <= 0.) {
+      G4cerr << "WARNING: non-positive importance replaced by 1" << G4endl;
+      imp = 1.;
+    }
+  }
+  return importances;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4String> ImportanceWorld::BiasedParticlesFromEnvironment()
+{
+  std::vector<G4String> particles;
+  const char* envParticles = std::getenv("NGAMMA_BIAS_PARTICLES");
+  std::string list = envParticles ? envParticles : "neutron,gamma";
+  for (auto& c : list) { if (c == ',') c = ' '; }
+  std::istringstream iss(list);
+  G4String name;
+  while (iss >> name) particles.push_back(name);
+  return particles;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
@@ -0,0 +1,153 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/MaterialScoringTable.cc
+/// \brief Implementation of the B1::MaterialScoringTable class
+
+#include "MaterialScoringTable.hh"
+
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4PhysicalConstants.hh"
+#include "DisplacementEnergyTable.hh"
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+MaterialScoringTable& MaterialScoringTable::Instance()
+{
+  static MaterialScoringTable instance;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void MaterialScoringTable::Build()
+{
+  // 首次调用时加载Z索引的位移阈值表（事件循环之前）
+  DisplacementEnergyTable::Instance();
+
+  const G4MaterialTable* materials = G4Material::GetMaterialTable();
+  fRecords.clear();
+  fRecords.reserve(materials->size());
+  for (const G4Material* material : *materials) {
+    fRecords.push_back(MakeRecord(material));
+  }
+  G4cout << "MaterialScoringTable: built scoring constants for "
+         << fRecords.size() << " materials" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const MaterialScoringRecord* MaterialScoringTable::Find(const G4Material* material) const
+{
+  std::size_t index = material->GetIndex();
+  return (index < fRecords.size()) ? &fRecords[index] : nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+MaterialScoringRecord MaterialScoringTable::MakeRecord(const G4Material* material)
+{
+  MaterialScoringRecord record;
+
+  // 质量分数加权的平均原子量与原子序
+  const G4ElementVector* elements = material->GetElementVector();
+  const G4double* fractions = material->GetFractionVector();
+  G4int nElements = material->GetNumberOfElements();
+  G4double Zsum = 0., Asum = 0.;
+  for (G4int i = 0; i < nElements; ++i) {
+    Zsum += (*elements)[i]->GetZ() * fractions[i];
+    Asum += (*elements)[i]->GetA() * fractions[i];
+  }
+  record.meanA = Asum;
+  if (Zsum > 0.) record.meanZ = Zsum;
+  if (Asum > 0.) record.nielA = Asum;
+
+  record.density = material->GetDensity();
+  record.atomDensity = (Asum > 0.) ? record.density * Avogadro / Asum : 0.;
+
+  record.nrtEd = NRTDisplacementThreshold(material);
+  record.srimEd = SRIMDisplacementThreshold(material);
+  return record;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 获取材料相关的位移阈值能量（NRT）
+G4double MaterialScoringTable::NRTDisplacementThreshold(const G4Material* material)
+{
+  const DisplacementEnergyTable& edTable = DisplacementEnergyTable::Instance();
+  G4String materialName = material->GetName();
+  const G4ElementVector* elements = material->GetElementVector();
+  const G4double* fractions = material->GetFractionVector();
+  G4int nElements = material->GetNumberOfElements();
+
+  // 基于闪烁体玻璃组分的位移阈值：玻璃典型值。
+  // 原SteppingAction按元素全名（"Oxygen"）查SRIM表，与按符号写的文件从不匹配，
+  // 实际总是取30 eV；此处保持该数值，改为按文件加权属于物理改动，另行处理
+  if (materialName.find("Glass") != G4String::npos || materialName.find("Scintillator") != G4String::npos) {
+    return 30.*eV;
+  }
+
+  // 元素特定的位移阈值（质量分数加权）
+  G4double weightedEd = 0.;
+  for (G4int i = 0; i < nElements; i++) {
+    weightedEd += edTable.GetNRT((*elements)[i]->GetZasInt()) * fractions[i];
+  }
+  return weightedEd;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 获取SRIM位移阈值
+G4double MaterialScoringTable::SRIMDisplacementThreshold(const G4Material* material)
+{
+  G4String materialName = material->GetName();
+
+  // 基于闪烁体玻璃组分的SRIM位移阈值
+  if (materialName.find("Glass") != G4String::npos || materialName.find("Scintillator") != G4String::npos) {
+    return 25.*eV;  // SRIM推荐的玻璃材料值
+  }
+
+  // 元素特定的SRIM位移阈值（质量分数加权）
+  const DisplacementEnergyTable& edTable = DisplacementEnergyTable::Instance();
+  const G4ElementVector* elements = material->GetElementVector();
+  const G4double* fractions = material->GetFractionVector();
+  G4int nElements = material->GetNumberOfElements();
+
+  G4double weightedEd = 0.;
+  for (G4int i = 0; i < nElements; i++) {
+    weightedEd += edTable.GetSRIM((*elements)[i]->GetZasInt()) * fractions[i];
+  }
+  return weightedEd;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
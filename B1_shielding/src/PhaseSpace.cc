@@ -0,0 +1,277 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/PhaseSpace.cc
+/// \brief Implementation of the B1::PhaseSpaceWriter and B1::PhaseSpaceReader classes
+
+#include "PhaseSpace.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AutoLock.hh"
+#include "G4Threading.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace B1
+{
+
+namespace {
+  const char kMagic[8] = {'N', 'G', 'P', 'H', 'S', 'P', '0', '1'};
+
+  struct Header
+  {
+    char magic[8];
+    std::uint32_t recordSize;
+    std::uint32_t reserved;
+    std::uint64_t nHistories;
+    std::uint64_t nRecords;
+  };
+  static_assert(sizeof(Header) == 32, "phase-space header must be 32 bytes");
+
+  // 写出：master打开的共享文件
+  G4Mutex writeMutex = G4MUTEX_INITIALIZER;
+  std::ofstream sharedOut;
+  G4String sharedOutPath;
+  std::uint64_t sharedRecords = 0;
+
+  // 回放：所有线程共享的读取位置
+  G4Mutex readMutex = G4MUTEX_INITIALIZER;
+  std::ifstream sharedIn;
+  G4String sharedInPath;
+  std::uint64_t inRecords = 0;
+  std::uint64_t inNextRecord = 0;
+  G4bool inWrapped = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceWriter::PhaseSpaceWriter()
+{
+  fBlock.reserve(kBlockRecords);
+  fMessenger = new G4GenericMessenger(this, "/phsp/", "Phase-space output at the glass exit");
+  fMessenger->DeclareProperty("enable", fEnabled)
+            .SetGuidance("Write every particle leaving the glass to <output dir>/phasespace.phsp");
+  fMessenger->DeclareMethod("particles", &PhaseSpaceWriter::SetParticles)
+            .SetGuidance("Restrict to particle names or PDG codes, e.g. \"neutron gamma\"; \"all\" for everything");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceWriter::~PhaseSpaceWriter()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceWriter::SetParticles(const G4String& list)
+{
+  fParticles.clear();
+  std::istringstream iss(list);
+  std::string token;
+  while (iss >> token) {
+    if (token == "all") { fParticles.clear(); return; }
+    if (std::isdigit(static_cast<unsigned char>(token[0])) || token[0] == '-') {
+      fParticles.push_back(std::stoi(token));
+    }
+    else if (auto def = G4ParticleTable::GetParticleTable()->FindParticle(token)) {
+      fParticles.push_back(def->GetPDGEncoding());
+    }
+    else {
+      G4cerr << "WARNING: /phsp/particles: unknown particle " << token << G4endl;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceWriter::OpenShared(const G4String& path)
+{
+  G4AutoLock lock(&writeMutex);
+  if (sharedOut.is_open()) sharedOut.close();
+  sharedOut.open(path, std::ios::binary | std::ios::trunc);
+  sharedOutPath = path;
+  sharedRecords = 0;
+  if (!sharedOut.good()) {
+    G4cerr << "WARNING: cannot open phase-space file " << path << G4endl;
+    return;
+  }
+  // 头部占位，run结束时补写历史数与记录数
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.recordSize = sizeof(PhaseSpaceRecord);
+  sharedOut.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  G4cout << "Phase-space output: " << path << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceWriter::CloseShared(G4int nEvents)
+{
+  G4AutoLock lock(&writeMutex);
+  if (!sharedOut.is_open()) return;
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.recordSize = sizeof(PhaseSpaceRecord);
+  header.nHistories = static_cast<std::uint64_t>(std::max(nEvents, 0));
+  header.nRecords = sharedRecords;
+  sharedOut.seekp(0);
+  sharedOut.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  sharedOut.close();
+  G4cout << "Phase-space: " << sharedRecords << " records from " << nEvents
+         << " histories written to " << sharedOutPath << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceWriter::Record(const G4Step* step, G4double weight)
+{
+  if (!fEnabled) return;
+  const G4Track* track = step->GetTrack();
+  const G4int pdg = track->GetDefinition()->GetPDGEncoding();
+  if (!fParticles.empty() && std::find(fParticles.begin(), fParticles.end(), pdg) == fParticles.end()) return;
+
+  const G4StepPoint* post = step->GetPostStepPoint();
+  const G4ThreeVector& pos = post->GetPosition();
+  const G4ThreeVector& dir = post->GetMomentumDirection();
+  PhaseSpaceRecord rec;
+  rec.pdg = pdg;
+  rec.x = static_cast<float>(pos.x() / mm);
+  rec.y = static_cast<float>(pos.y() / mm);
+  rec.z = static_cast<float>(pos.z() / mm);
+  rec.u = static_cast<float>(dir.x());
+  rec.v = static_cast<float>(dir.y());
+  rec.w = static_cast<float>(dir.z());
+  rec.energy = static_cast<float>(post->GetKineticEnergy() / MeV);
+  rec.time = static_cast<float>(post->GetGlobalTime() / ns);
+  rec.weight = static_cast<float>(weight);
+  fBlock.push_back(rec);
+  if (fBlock.size() >= kBlockRecords) Flush();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceWriter::Flush()
+{
+  if (fBlock.empty()) return;
+  G4AutoLock lock(&writeMutex);
+  if (sharedOut.is_open()) {
+    sharedOut.write(reinterpret_cast<const char*>(fBlock.data()),
+                    static_cast<std::streamsize>(fBlock.size() * sizeof(PhaseSpaceRecord)));
+    sharedRecords += fBlock.size();
+  }
+  fBlock.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhaseSpaceReader::Open(const G4String& path)
+{
+  G4AutoLock lock(&readMutex);
+  if (sharedIn.is_open() && sharedInPath == path) {
+    // 重新设置同一文件：从第一条记录开始。只由master复位（sequential模式下即唯一线程）；
+    // worker重放的同一命令不动共享读取位置，以免打断其他线程已开始的读取
+    if (G4Threading::IsMasterThread()) {
+      inNextRecord = 0;
+      inWrapped = false;
+      G4cout << "Phase-space source: " << path << " rewound to the first record" << G4endl;
+    }
+    return true;
+  }
+  if (sharedIn.is_open()) sharedIn.close();
+
+  sharedIn.open(path, std::ios::binary);
+  Header header{};
+  if (!sharedIn.good() || !sharedIn.read(reinterpret_cast<char*>(&header), sizeof(header))
+      || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+      || header.recordSize != sizeof(PhaseSpaceRecord)) {
+    G4cerr << "WARNING: " << path << " is not a phase-space file" << G4endl;
+    sharedIn.close();
+    sharedInPath.clear();
+    return false;
+  }
+  sharedInPath = path;
+  inRecords = header.nRecords;
+  inNextRecord = 0;
+  inWrapped = false;
+  G4cout << "Phase-space source: " << path << ", " << header.nRecords << " records from "
+         << header.nHistories << " histories";
+  if (header.nHistories > 0) {
+    G4cout << " (scale per-record tallies by " << static_cast<G4double>(header.nRecords) / header.nHistories
+           << " for per-source-particle results)";
+  }
+  G4cout << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhaseSpaceReader::IsOpen()
+{
+  G4AutoLock lock(&readMutex);
+  return sharedIn.is_open() && inRecords > 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhaseSpaceReader::NextBlock(std::vector<PhaseSpaceRecord>& block, std::size_t n)
+{
+  G4AutoLock lock(&readMutex);
+  block.clear();
+  if (!sharedIn.is_open() || inRecords == 0) return false;
+
+  if (inNextRecord >= inRecords) {
+    // 文件用尽：从头开始
+    if (!inWrapped) {
+      G4cerr << "WARNING: phase-space file " << sharedInPath
+             << " exhausted, restarting from the first record"
+             << " (reused records are not independent histories: R/VOV/FOM are optimistic)" << G4endl;
+      inWrapped = true;
+    }
+    inNextRecord = 0;
+  }
+  std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(n, inRecords - inNextRecord));
+  block.resize(count);
+  sharedIn.clear();
+  sharedIn.seekg(static_cast<std::streamoff>(sizeof(Header) + inNextRecord * sizeof(PhaseSpaceRecord)));
+  sharedIn.read(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(count * sizeof(PhaseSpaceRecord)));
+  block.resize(static_cast<std::size_t>(sharedIn.gcount()) / sizeof(PhaseSpaceRecord));
+  inNextRecord += count;
+  return !block.empty();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
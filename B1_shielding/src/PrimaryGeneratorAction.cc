@@ -28,13 +28,19 @@
 /// \brief Implementation of the B1::PrimaryGeneratorAction class
 
 #include "PrimaryGeneratorAction.hh"
+#include "ResponseMatrix.hh"
+#include "DetectorConstruction.hh"
 
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
 #include "G4Box.hh"
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
 #include "G4RunManager.hh"
 #include "G4ParticleGun.hh"
 #include "G4ParticleTable.hh"
+#include "G4IonTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4ios.hh"
@@ -49,17 +55,18 @@
 namespace B1
 {
 
-//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-
 PrimaryGeneratorAction::PrimaryGeneratorAction()
 {
   G4cout << "PrimaryGeneratorAction constructor called" << G4endl;
 
-  // 默认模式：从环境变量NGAMMA_SOURCE_MODE读取（gps|cf252），默认gps
+  // 默认模式：从环境变量NGAMMA_SOURCE_MODE读取（gps|cf252|response|phsp），默认gps；
+  // phsp 仍需宏中的 /source/phsp/file 给出相空间文件
   fMode = SourceMode::GPS;
   if (const char* env = std::getenv("NGAMMA_SOURCE_MODE")) {
     G4String m(env);
     if (m == "cf252" || m == "CF252") fMode = SourceMode::CF252;
+    else if (m == "response") fMode = SourceMode::RESPONSE;
+    else if (m == "phsp") fMode = SourceMode::PHSP;
     else fMode = SourceMode::GPS;
   }
 
@@ -76,28 +83,70 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
   fHalfY = 10.0;   // 20 cm 高的一半
   fSourceZ = -10.0;
 
-  // Watt谱参数（MeV, 1/MeV）并初始化CDF查找表
+  // Watt谱参数（MeV, 1/MeV），缺省精确抽样
   fWattA_MeV = 1.025;
   fWattB_perMeV = 2.926;
-  initializeCf252Spectrum();
 
-  // UI: /source/mode cf252|gps
+  // response 模式缺省覆盖响应矩阵的全部入射能区
+  fResponseEmin = ResponseMatrix::kEinMinMeV*MeV;
+  fResponseEmax = ResponseMatrix::kEmaxMeV*MeV;
+
+  // UI: /source/mode cf252|gps|response
   fMessenger = new G4GenericMessenger(this, "/source/", "Primary source control");
   fMessenger->DeclareMethod("mode", &PrimaryGeneratorAction::SetMode)
-            .SetGuidance("Set source mode: cf252 or gps");
+            .SetGuidance("Set source mode: cf252, gps, response or phsp");
+  fMessenger->DeclareProperty("biasToSlab", fBiasToSlab)
+            .SetGuidance("cf252 mode: emit only toward the glass front face and weight each primary")
+            .SetGuidance("by (true pdf)/(biased pdf), so all weighted tallies stay unbiased");
+  fSpectrumMessenger = new G4GenericMessenger(this, "/source/spectrum/", "cf252-mode energy spectrum");
+  fSpectrumMessenger->DeclareMethod("file", &PrimaryGeneratorAction::SetSpectrumFile)
+                    .SetGuidance("Sample cf252-mode energies from a tabulated spectrum file (lines: E[MeV] density)")
+                    .SetGuidance("e.g. Cf252_Watt_spectrum.dat; O(1) alias-table sampling on a fine log grid");
+  fSpectrumMessenger->DeclareMethod("watt", &PrimaryGeneratorAction::UseWattSpectrum)
+                    .SetGuidance("Return to exact (table-free) Watt sampling, the default");
+  fPhspMessenger = new G4GenericMessenger(this, "/source/phsp/", "Phase-space replay source");
+  fPhspMessenger->DeclareMethod("file", &PrimaryGeneratorAction::SetPhaseSpaceFile)
+                .SetGuidance("Replay a phase-space file written with /phsp/enable (switches to /source/mode phsp)");
+  fPhspMessenger->DeclareProperty("recycle", fPhspRecycle)
+                .SetGuidance("Use every record N times in a row (default 1)")
+                .SetGuidance("Reuses are counted as independent histories: R/VOV from tally statistics are underestimated")
+                .SetParameterName("N", false)
+                .SetRange("N>=1");
+  fPhspMessenger->DeclareProperty("rotate", fPhspRotate)
+                .SetGuidance("Rotate each replayed particle by a random angle about the z axis")
+                .SetGuidance("(only valid when the upstream set-up is symmetric about z)");
+  fResponseMessenger = new G4GenericMessenger(this, "/source/response/", "Response-matrix source (GPS geometry, log-uniform energy)");
+  fResponseMessenger->DeclareMethodWithUnit("emin", "MeV", &PrimaryGeneratorAction::SetResponseEmin)
+                    .SetGuidance("Lower edge of the log-uniform primary energy range (> 0, < emax)");
+  fResponseMessenger->DeclareMethodWithUnit("emax", "MeV", &PrimaryGeneratorAction::SetResponseEmax)
+                    .SetGuidance("Upper edge of the log-uniform primary energy range (> emin)");
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
+  delete fResponseMessenger;
+  delete fSpectrumMessenger;
+  delete fPhspMessenger;
   delete fParticleGun;
 }
 
+G4String PrimaryGeneratorAction::GetSourceTag() const
+{
+  switch (fMode) {
+    case SourceMode::CF252: return fUseTabulated ? "Tabulated" : "Cf252_Watt";
+    case SourceMode::RESPONSE: return "Response";
+    case SourceMode::PHSP: return "PhaseSpace";
+    default: return "GPS";
+  }
+}
+
 // Helper for run labeling: return current particle tag
 G4String PrimaryGeneratorAction::GetParticleTag() const
 {
   if (fMode == SourceMode::CF252) return "neutron";
+  if (fMode == SourceMode::PHSP) return "phsp";
   // GPS mode: try to read particle from GPS definition
   if (fGPS) {
     const G4ParticleDefinition* def = fGPS->GetParticleDefinition();
@@ -116,71 +165,176 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
     return;
   }
 
+  if (fMode == SourceMode::PHSP) {
+    generatePhaseSpacePrimary(anEvent);
+    return;
+  }
+
+  if (fMode == SourceMode::RESPONSE) {
+    // GPS给出位置/方向/粒子，再把能量改为对数均匀抽样
+    // （GPS的能量分布在MT下为线程共享数据，不能逐事件修改，只改本事件的初级粒子）
+    fGPS->GeneratePrimaryVertex(anEvent);
+    const G4double energy = fResponseEmin * std::pow(fResponseEmax / fResponseEmin, G4UniformRand());
+    for (G4int i = 0; i < anEvent->GetNumberOfPrimaryVertex(); ++i) {
+      G4PrimaryVertex* vertex = anEvent->GetPrimaryVertex(i);
+      for (G4PrimaryParticle* primary = vertex->GetPrimary(); primary; primary = primary->GetNext()) {
+        primary->SetKineticEnergy(energy);
+      }
+    }
+    return;
+  }
+
   // 1) 位置：矩形面上均匀采样 (单位转换到 mm)
   const G4double x_cm = (2.0*G4UniformRand()-1.0) * fHalfX;
   const G4double y_cm = (2.0*G4UniformRand()-1.0) * fHalfY;
   const G4double z_cm = fSourceZ;
   fParticleGun->SetParticlePosition(G4ThreeVector(x_cm*cm, y_cm*cm, z_cm*cm));
 
-  // 2) 方向：+Z 半空间各向同性
-  const G4double u = G4UniformRand();        // cos(theta) in [0,1]
-  const G4double cosTheta = u;
-  const G4double sinTheta = std::sqrt(std::max(0.0, 1.0 - cosTheta*cosTheta));
-  const G4double phi = 2.0*M_PI*G4UniformRand();
-  const G4double dx = sinTheta*std::cos(phi);
-  const G4double dy = sinTheta*std::sin(phi);
-  const G4double dz = cosTheta;               // 指向 +Z 半球
-  fParticleGun->SetParticleMomentumDirection(G4ThreeVector(dx, dy, dz));
+  // 2) 方向：+Z 半空间各向同性；偏倚时只朝玻璃前表面发射
+  G4ThreeVector direction;
+  G4double weight = 1.0;
+  if (!fBiasToSlab || !sampleDirectionTowardSlab(fParticleGun->GetParticlePosition(), direction, weight)) {
+    const G4double u = G4UniformRand();        // cos(theta) in [0,1]
+    const G4double cosTheta = u;
+    const G4double sinTheta = std::sqrt(std::max(0.0, 1.0 - cosTheta*cosTheta));
+    const G4double phi = 2.0*M_PI*G4UniformRand();
+    const G4double dx = sinTheta*std::cos(phi);
+    const G4double dy = sinTheta*std::sin(phi);
+    const G4double dz = cosTheta;               // 指向 +Z 半球
+    direction.set(dx, dy, dz);
+  }
+  fParticleGun->SetParticleMomentumDirection(direction);
 
   // 3) 能量：按Watt分布抽样（MeV）
   const G4double eMeV = sampleCf252EnergyMeV();
   fParticleGun->SetParticleEnergy(eMeV*MeV);
 
-  // 发射
+  // 发射（顶点权重传给初级径迹，所有计分按步前点权重加权）
   fParticleGun->GeneratePrimaryVertex(anEvent);
+  if (weight != 1.0) anEvent->GetPrimaryVertex()->SetWeight(weight);
 }
 
-void PrimaryGeneratorAction::initializeCf252Spectrum()
+void PrimaryGeneratorAction::generatePhaseSpacePrimary(G4Event* anEvent)
 {
-  // 构建能量网格与未归一化PDF：f(E) = exp(-E/a)*sinh(sqrt(b E))
-  // 取 0.0 到 12.0 MeV，步长 0.05 MeV，避免0点奇异从1e-6开始
-  const G4double eMin = 1e-6;  // MeV
-  const G4double eMax = 12.0;  // MeV
-  const G4double de   = 0.05;  // MeV
-
-  fEgridMeV.clear();
-  fCdf.clear();
-
-  G4double accum = 0.0;
-  for (G4double E=eMin; E<=eMax+0.5*de; E+=de) {
-    const G4double val = std::exp(-E/fWattA_MeV) * std::sinh(std::sqrt(std::max(0.0, fWattB_perMeV*E)));
-    fEgridMeV.push_back(E);
-    accum += val;
-    fCdf.push_back(accum);
-  }
-  // 归一化CDF到[0,1]
-  if (!fCdf.empty() && fCdf.back()>0) {
-    const G4double norm = fCdf.back();
-    for (auto &c : fCdf) c /= norm;
+  // 当前记录用满 recycle 次后取下一条；线程内的块用完再从共享读取位置取一块
+  if (fPhspUses >= fPhspRecycle) {
+    fPhspUses = 0;
+    ++fPhspIndex;
+  }
+  if (fPhspIndex >= fPhspBlock.size()) {
+    fPhspIndex = 0;
+    if (!PhaseSpaceReader::NextBlock(fPhspBlock, 1024)) {
+      G4Exception("PrimaryGeneratorAction::GeneratePrimaries", "PHSP001", EventMustBeAborted,
+                  "phsp mode without a readable phase-space file (use /source/phsp/file)");
+      return;
+    }
+  }
+  const PhaseSpaceRecord& rec = fPhspBlock[fPhspIndex];
+  ++fPhspUses;
+
+  G4ParticleDefinition* particle = G4ParticleTable::GetParticleTable()->FindParticle(rec.pdg);
+  if (!particle) particle = G4IonTable::GetIonTable()->GetIon(rec.pdg);
+  if (!particle) {
+    G4Exception("PrimaryGeneratorAction::GeneratePrimaries", "PHSP002", EventMustBeAborted,
+                "unknown PDG code in phase-space record");
+    return;
+  }
+
+  G4ThreeVector position(rec.x*mm, rec.y*mm, rec.z*mm);
+  G4ThreeVector direction(rec.u, rec.v, rec.w);
+  if (fPhspRotate) {
+    const G4double phi = 2.0*M_PI*G4UniformRand();
+    position.rotateZ(phi);
+    direction.rotateZ(phi);
   }
+  fParticleGun->SetParticleDefinition(particle);
+  fParticleGun->SetParticlePosition(position);
+  fParticleGun->SetParticleMomentumDirection(direction.unit());
+  fParticleGun->SetParticleEnergy(rec.energy*MeV);
+  fParticleGun->SetParticleTime(rec.time*ns);
+  fParticleGun->GeneratePrimaryVertex(anEvent);
+  anEvent->GetPrimaryVertex()->SetWeight(rec.weight);
+}
+
+G4bool PrimaryGeneratorAction::sampleDirectionTowardSlab(const G4ThreeVector& position, G4ThreeVector& direction,
+                                                         G4double& weight) const
+{
+  const auto detector = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  if (!detector) return false;
+  const G4double halfXY = 0.5 * detector->GetGlassSizeXY();
+  const G4double zFront = -0.5 * detector->GetGlassSizeZ();  // 玻璃放置于原点
+  // 源点须在玻璃横向范围内：此时打到侧面的射线必先穿过前表面，前表面即玻璃所张的全部立体角
+  // （缺省源面与玻璃同为20×20 cm）；范围外的源点按原样各向同性发射，整体仍无偏
+  if (halfXY <= 0. || position.z() >= zFront) return false;
+  if (std::abs(position.x()) > halfXY || std::abs(position.y()) > halfXY) return false;
+
+  // 在前表面上均匀取目标点：立体角pdf = d^2/(A cos(alpha))，真实pdf = 1/(2 pi)（半球各向同性）
+  const G4ThreeVector target((2.0*G4UniformRand()-1.0) * halfXY, (2.0*G4UniformRand()-1.0) * halfXY, zFront);
+  const G4ThreeVector path = target - position;
+  const G4double dist2 = path.mag2();
+  const G4double dist = std::sqrt(dist2);
+  const G4double cosAlpha = path.z() / dist;
+  const G4double area = 4.0 * halfXY * halfXY;
+  direction = path / dist;
+  weight = area * cosAlpha / (2.0 * M_PI * dist2);
+  return true;
 }
 
 G4double PrimaryGeneratorAction::sampleCf252EnergyMeV() const
 {
-  if (fEgridMeV.empty() || fCdf.empty()) return 2.1; // 后备
-  const G4double r = G4UniformRand();
-  // 在CDF上二分查找
-  auto it = std::lower_bound(fCdf.begin(), fCdf.end(), r);
-  if (it == fCdf.begin()) return fEgridMeV.front();
-  if (it == fCdf.end()) return fEgridMeV.back();
-  size_t idx = std::distance(fCdf.begin(), it);
-  // 线性内插CDF反演
-  const G4double c1 = fCdf[idx-1];
-  const G4double c2 = fCdf[idx];
-  const G4double e1 = fEgridMeV[idx-1];
-  const G4double e2 = fEgridMeV[idx];
-  const G4double t = (c2>c1) ? ( (r-c1)/(c2-c1) ) : 0.0;
-  return e1 + t*(e2-e1);
+  // 表格谱：别名表O(1)抽样；否则Watt谱精确抽样（无网格离散误差），
+  // 截断在原CDF网格的 1e-6～12 MeV 范围内，与以前的源谱一致
+  if (fUseTabulated && fSpectrum.IsValid()) return fSpectrum.Sample();
+  return TabulatedSpectrum::SampleWatt(fWattA_MeV, fWattB_perMeV, kWattEminMeV, kWattEmaxMeV);
+}
+
+void PrimaryGeneratorAction::SetSpectrumFile(const G4String& fileName)
+{
+  if (fSpectrum.Load(fileName)) {
+    fUseTabulated = true;
+  }
+  else {
+    G4cerr << "[source] keeping previous cf252-mode spectrum" << G4endl;
+  }
+}
+
+void PrimaryGeneratorAction::SetPhaseSpaceFile(const G4String& fileName)
+{
+  if (!PhaseSpaceReader::Open(fileName)) return;
+  fPhspBlock.clear();
+  fPhspIndex = 0;
+  fPhspUses = 0;
+  SetMode("phsp");
+}
+
+void PrimaryGeneratorAction::UseWattSpectrum()
+{
+  fUseTabulated = false;
+  G4cout << "[source] cf252-mode energy: exact Watt sampling (a = " << fWattA_MeV
+         << " MeV, b = " << fWattB_perMeV << " /MeV, " << kWattEminMeV << " - " << kWattEmaxMeV
+         << " MeV)" << G4endl;
+}
+
+void PrimaryGeneratorAction::SetResponseEmin(G4double emin)
+{
+  // 对数均匀抽样要求 0 < emin < emax，否则 pow 给出 NaN/负能量
+  if (emin <= 0. || emin >= fResponseEmax) {
+    G4cerr << "WARNING: /source/response/emin must be > 0 and < emax (" << fResponseEmax/MeV
+           << " MeV); keeping " << fResponseEmin/MeV << " MeV" << G4endl;
+    return;
+  }
+  fResponseEmin = emin;
+}
+
+void PrimaryGeneratorAction::SetResponseEmax(G4double emax)
+{
+  if (emax <= fResponseEmin) {
+    G4cerr << "WARNING: /source/response/emax must be > emin (" << fResponseEmin/MeV
+           << " MeV); keeping " << fResponseEmax/MeV << " MeV" << G4endl;
+    return;
+  }
+  fResponseEmax = emax;
 }
 
 void PrimaryGeneratorAction::SetMode(const G4String& mode)
@@ -188,8 +342,22 @@ void PrimaryGeneratorAction::SetMode(const G4String& mode)
   if (mode == "gps" || mode == "GPS") {
     fMode = SourceMode::GPS;
     G4cout << "[source] mode = gps (macro-controlled)" << G4endl;
+  } else if (mode == "phsp") {
+    fMode = SourceMode::PHSP;
+    G4cout << "[source] mode = phsp (phase-space replay)" << G4endl;
+  } else if (mode == "response") {
+    fMode = SourceMode::RESPONSE;
+    G4cout << "[source] mode = response (GPS geometry, log-uniform energy "
+           << fResponseEmin/MeV << " - " << fResponseEmax/MeV << " MeV)" << G4endl;
+    if (!ResponseMatrix::Enabled()) {
+      G4cerr << "WARNING: response matrix not booked; start with NGAMMA_SOURCE_MODE=response"
+             << " or NGAMMA_RESPONSE_MATRIX=1 to score it" << G4endl;
+    }
   } else {
     fMode = SourceMode::CF252;
+    // phsp 回放会改写粒子枪的粒子与时间，切回时复位
+    fParticleGun->SetParticleDefinition(G4ParticleTable::GetParticleTable()->FindParticle("neutron"));
+    fParticleGun->SetParticleTime(0.);
     G4cout << "[source] mode = cf252 (built-in Watt + surface)" << G4endl;
   }
 }
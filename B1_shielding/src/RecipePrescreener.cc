@@ -0,0 +1,255 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/RecipePrescreener.cc
+/// \brief Implementation of the B1::RecipePrescreener class
+
+#include "RecipePrescreener.hh"
+#include "GlassMaterialRegistry.hh"
+
+#include "G4RunManager.hh"
+#include "G4EmCalculator.hh"
+#include "G4HadronicProcessStore.hh"
+#include "G4Neutron.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace B1
+{
+
+namespace {
+  // Cf-252 Watt谱参数，与 PrimaryGeneratorAction 一致
+  const G4double kWattA_MeV = 1.025;
+  const G4double kWattB_perMeV = 2.926;
+  // 快中子移出截面的平均区间
+  const G4double kRemovalEmin = 1.0*MeV;
+  const G4double kRemovalEmax = 15.0*MeV;
+  const G4int kRemovalPoints = 60;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RecipePrescreener::RecipePrescreener(G4double gammaRefEnergy)
+  : fGammaRefEnergy(gammaRefEnergy)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const std::vector<G4double>& RecipePrescreener::GammaEnergies()
+{
+  // Am-241、低能散射区、Cs-137、Co-60、俘获伽马（Gd/B/H）的典型能量
+  static const std::vector<G4double> energies = {
+    59.5*keV, 100*keV, 300*keV, 662*keV, 1.0*MeV, 1.25*MeV, 2.0*MeV, 4.4*MeV, 8.0*MeV};
+  return energies;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int RecipePrescreener::Run(const G4String& recipeList, const G4String& outCsv)
+{
+  std::ifstream fin(recipeList);
+  if (!fin.good()) {
+    G4cerr << "[PRESCREEN] Cannot open recipe list: " << recipeList << G4endl;
+    return -1;
+  }
+
+  // 先建全部材料再建表：HP数据按建表时已存在的元素加载
+  auto& registry = GlassMaterialRegistry::Instance();
+  std::vector<std::pair<G4String, G4Material*>> recipes;
+  std::vector<G4String> failed;
+  std::string line;
+  while (std::getline(fin, line)) {
+    std::istringstream iss(line);
+    std::string path;
+    if (!(iss >> path) || path[0] == '#') continue;
+    G4String error;
+    G4Material* material = registry.GetGlassFromFile(path, &error);
+    if (!material) {
+      G4cerr << "[PRESCREEN] Cannot build glass from " << path << ": " << error << G4endl;
+      failed.push_back(path);
+      continue;
+    }
+    recipes.push_back({path, material});
+  }
+  if (recipes.empty()) {
+    G4cerr << "[PRESCREEN] No usable recipes in " << recipeList << G4endl;
+    return -1;
+  }
+
+  // 空run：只初始化物理表，不产生事件（RunAction不被调用）
+  G4RunManager::GetRunManager()->BeamOn(0);
+
+  std::vector<Result> results;
+  results.reserve(recipes.size());
+  for (const auto& [path, material] : recipes) results.push_back(Evaluate(path, material));
+  RankPareto(results);
+  std::stable_sort(results.begin(), results.end(), [](const Result& a, const Result& b) {
+    return (a.rank != b.rank) ? a.rank < b.rank : a.muRef > b.muRef;
+  });
+  if (!Write(results, failed, outCsv)) return -1;
+
+  G4cout << "[PRESCREEN] " << results.size() << " recipes, reference gamma energy "
+         << fGammaRefEnergy / keV << " keV -> " << outCsv << G4endl;
+  G4cout << "[PRESCREEN] rank  mu(1/cm)  Sigma_c,th(1/cm)  Sigma_r,Watt(1/cm)  recipe" << G4endl;
+  for (const auto& r : results) {
+    G4cout << "[PRESCREEN] " << std::setw(4) << r.rank << "  "
+           << std::setw(8) << std::setprecision(4) << r.muRef * cm << "  "
+           << std::setw(16) << r.captureThermal * cm << "  "
+           << std::setw(18) << r.removalWatt * cm << "  " << r.recipe << G4endl;
+  }
+  if (!failed.empty()) {
+    G4cout << "[PRESCREEN] " << failed.size() << " recipes failed to parse (listed in " << outCsv << ")" << G4endl;
+  }
+  return static_cast<G4int>(failed.size());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RecipePrescreener::Result RecipePrescreener::Evaluate(const G4String& recipe, G4Material* material) const
+{
+  Result r;
+  r.recipe = recipe;
+  r.material = material;
+
+  G4EmCalculator calculator;
+  const G4double density = material->GetDensity();
+  for (G4double energy : GammaEnergies()) {
+    G4double lambda = calculator.ComputeGammaAttenuationLength(energy, material);
+    r.muRho.push_back((lambda > 0. && lambda < DBL_MAX) ? 1. / (lambda * density) : 0.);
+  }
+  G4double lambdaRef = calculator.ComputeGammaAttenuationLength(fGammaRefEnergy, material);
+  r.muRef = (lambdaRef > 0. && lambdaRef < DBL_MAX) ? 1. / lambdaRef : 0.;
+
+  auto store = G4HadronicProcessStore::Instance();
+  const auto neutron = G4Neutron::Definition();
+  r.captureThermal = store->GetCaptureCrossSectionPerVolume(neutron, 0.0253*eV, material);
+  r.capture1eV = store->GetCaptureCrossSectionPerVolume(neutron, 1.0*eV, material);
+  r.capture1keV = store->GetCaptureCrossSectionPerVolume(neutron, 1.0*keV, material);
+  r.removal2MeV = RemovalCrossSection(material, 2.0*MeV);
+
+  // Watt谱加权平均（对数网格上梯形积分）
+  G4double sum = 0., norm = 0.;
+  G4double prevE = 0., prevW = 0., prevS = 0.;
+  for (G4int i = 0; i <= kRemovalPoints; ++i) {
+    G4double energy = kRemovalEmin * std::pow(kRemovalEmax / kRemovalEmin, G4double(i) / kRemovalPoints);
+    G4double eMeV = energy / MeV;
+    G4double weight = std::exp(-eMeV / kWattA_MeV) * std::sinh(std::sqrt(kWattB_perMeV * eMeV));
+    G4double sigma = RemovalCrossSection(material, energy);
+    if (i > 0) {
+      G4double dE = eMeV - prevE;
+      sum += 0.5 * dE * (weight * sigma + prevW * prevS);
+      norm += 0.5 * dE * (weight + prevW);
+    }
+    prevE = eMeV; prevW = weight; prevS = sigma;
+  }
+  r.removalWatt = (norm > 0.) ? sum / norm : 0.;
+  return r;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double RecipePrescreener::RemovalCrossSection(const G4Material* material, G4double energy) const
+{
+  auto store = G4HadronicProcessStore::Instance();
+  const auto neutron = G4Neutron::Definition();
+  const G4double* atomDensity = material->GetVecNbOfAtomsPerVolume();
+  G4double sigma = 0.;
+  for (std::size_t i = 0; i < material->GetNumberOfElements(); ++i) {
+    const G4Element* element = material->GetElement(static_cast<G4int>(i));
+    G4double inelastic = store->GetInelasticCrossSectionPerAtom(neutron, energy, element, material);
+    G4double elastic = store->GetElasticCrossSectionPerAtom(neutron, energy, element, material);
+    // 弹性散射取输运修正 (1 - <cosθ>)，<cosθ> = 2/(3A)（质心系各向同性）
+    sigma += atomDensity[i] * (inelastic + elastic * (1. - 2. / (3. * element->GetN())));
+  }
+  return sigma;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RecipePrescreener::RankPareto(std::vector<Result>& results)
+{
+  // 三个目标均越大越好；逐层剥离非支配集
+  auto dominates = [](const Result& a, const Result& b) {
+    G4bool geq = a.muRef >= b.muRef && a.captureThermal >= b.captureThermal && a.removalWatt >= b.removalWatt;
+    G4bool gt = a.muRef > b.muRef || a.captureThermal > b.captureThermal || a.removalWatt > b.removalWatt;
+    return geq && gt;
+  };
+  std::size_t ranked = 0;
+  for (G4int rank = 1; ranked < results.size(); ++rank) {
+    std::vector<std::size_t> front;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      if (results[i].rank != 0) continue;
+      G4bool dominated = false;
+      for (std::size_t j = 0; j < results.size() && !dominated; ++j) {
+        if (j != i && results[j].rank == 0 && dominates(results[j], results[i])) {
+          dominated = true;
+        }
+      }
+      if (!dominated) front.push_back(i);
+    }
+    for (auto i : front) results[i].rank = rank;
+    ranked += front.size();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool RecipePrescreener::Write(const std::vector<Result>& results, const std::vector<G4String>& failed,
+                                const G4String& outCsv) const
+{
+  std::ofstream fout(outCsv);
+  if (!fout.good()) {
+    G4cerr << "[PRESCREEN] Cannot write " << outCsv << G4endl;
+    return false;
+  }
+  fout << "rank,recipe,material,density_g_cm3,mu_ref_cm-1,capture_thermal_cm-1,removal_watt_cm-1,"
+       << "capture_1eV_cm-1,capture_1keV_cm-1,removal_2MeV_cm-1";
+  for (G4double energy : GammaEnergies()) fout << ",mu_rho_" << energy / keV << "keV_cm2_g";
+  fout << "\n# reference gamma energy = " << fGammaRefEnergy / keV << " keV\n";
+  fout << std::setprecision(6);
+  for (const auto& r : results) {
+    fout << r.rank << "," << r.recipe << "," << r.material->GetName() << ","
+         << r.material->GetDensity() / (g/cm3) << ","
+         << r.muRef * cm << "," << r.captureThermal * cm << "," << r.removalWatt * cm << ","
+         << r.capture1eV * cm << "," << r.capture1keV * cm << "," << r.removal2MeV * cm;
+    for (G4double muRho : r.muRho) fout << "," << muRho * (g/cm2);
+    fout << "\n";
+  }
+  for (const auto& path : failed) fout << "# failed: " << path << "\n";
+  return fout.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
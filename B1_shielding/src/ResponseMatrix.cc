@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/ResponseMatrix.cc
+/// \brief Implementation of the B1::ResponseMatrix class
+
+#include "ResponseMatrix.hh"
+#include "ScoringBuffer.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cstdlib>
+
+namespace B1
+{
+
+namespace {
+  // 直方图编号：H2紧接深度透射的H2 2/3，H1紧接 Depth_Plane_mm（H1 10）
+  const G4int kNeutronTransmitH2 = 4;
+  const G4int kGammaTransmitH2 = 5;
+  const G4int kCaptureGammaH2 = 6;
+  const G4int kPrimaryH1 = 11;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ResponseMatrix::Enabled()
+{
+  static const G4bool enabled = [] {
+    const char* mode = std::getenv("NGAMMA_SOURCE_MODE");
+    const char* flag = std::getenv("NGAMMA_RESPONSE_MATRIX");
+    return (mode && G4String(mode) == "response")
+           || (flag && flag[0] != '\0' && G4String(flag) != "0");
+  }();
+  return enabled;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::Book()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  const G4double einMin = kEinMinMeV*MeV, emax = kEmaxMeV*MeV;
+  analysisManager->CreateH2("Response_Neutron_Transmit", "Transmitted neutrons: E_in x E_out",
+                            kNumBins, einMin, emax, kNumBins, kNeutronEoutMinMeV*MeV, emax,
+                            "MeV", "MeV", "none", "none", "log", "log");
+  analysisManager->CreateH2("Response_Gamma_Transmit", "Transmitted gammas: E_in x E_out",
+                            kNumBins, einMin, emax, kNumBins, kGammaEoutMinMeV*MeV, emax,
+                            "MeV", "MeV", "none", "none", "log", "log");
+  analysisManager->CreateH2("Response_Capture_Gamma", "Capture gammas: E_in x E_gamma",
+                            kNumBins, einMin, emax, kNumBins, kGammaEoutMinMeV*MeV, emax,
+                            "MeV", "MeV", "none", "none", "log", "log");
+  analysisManager->CreateH1("Response_Primary_E", "Primary energy (response normalisation)",
+                            kNumBins, einMin, emax, "MeV", "none", "log");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::FillPrimary(G4double primaryEnergy, G4double weight)
+{
+  if (!Enabled()) return;
+  G4AnalysisManager::Instance()->FillH1(kPrimaryH1, primaryEnergy, weight);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::FillTransmit(ScoringBuffer& buffer, G4int pdg, G4double primaryEnergy,
+                                  G4double exitEnergy, G4double weight)
+{
+  if (!Enabled()) return;
+  G4int id = (pdg == 2112) ? kNeutronTransmitH2 : (pdg == 22) ? kGammaTransmitH2 : -1;
+  if (id < 0) return;
+  buffer.FillH2(id, primaryEnergy, exitEnergy, weight);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::FillCapture(ScoringBuffer& buffer, G4double primaryEnergy, G4double gammaEnergy,
+                                 G4double weight)
+{
+  if (!Enabled()) return;
+  buffer.FillH2(kCaptureGammaH2, primaryEnergy, gammaEnergy, weight);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
@@ -30,9 +30,14 @@
 #include "RunAction.hh"
 #include "DetectorConstruction.hh"
 #include "PrimaryGeneratorAction.hh"
+#include "MaterialScoringTable.hh"
+#include "DamageFunctionTable.hh"
+#include "CustomPhysicsList.hh"
+#include "ResponseMatrix.hh"
 
 #include "G4Run.hh"
 #include "G4RunManager.hh"
+#include "G4RunManagerKernel.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4AccumulableManager.hh"
@@ -40,10 +45,12 @@
 #include "G4ParticleGun.hh"
 #include "G4GeneralParticleSource.hh"
 #include "G4SPSEneDistribution.hh"
+#include "G4AutoLock.hh"
 #include "TTree.h"
 #include "TFile.h"
 #include <filesystem>
 #include <ctime>
+#include <iomanip>
 #include <sstream>
 #include <fstream>
 #include <cstdlib>
@@ -51,9 +58,28 @@
 namespace B1
 {
 
+namespace {
+  // master线程生成的输出文件名，worker线程在各自BeginOfRunAction中打开同名文件以参与合并
+  G4Mutex outputFileMutex = G4MUTEX_INITIALIZER;
+  G4String sharedOutputFileName;
+
+  // 源粒子与源类型标签（输出目录名与run目录使用）
+  // MT/Tasking：master线程没有注册的PrimaryGeneratorAction，使用master自己的源实例
+  void GetSourceTags(const PrimaryGeneratorAction* masterSource, G4String& particle, G4String& source)
+  {
+    auto pga = dynamic_cast<const PrimaryGeneratorAction*>(G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction());
+    if (!pga) pga = masterSource;
+    if (pga) {
+      particle = pga->GetParticleTag();
+      source = pga->GetSourceTag();
+    }
+  }
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-RunAction::RunAction() : fTrackTree(nullptr)
+RunAction::RunAction(PrimaryGeneratorAction* masterSource)
+  : fMasterSource(masterSource), fTrackTree(nullptr)
 {
   G4cout << "RunAction constructor called" << G4endl;
   
@@ -72,6 +98,16 @@ RunAction::RunAction() : fTrackTree(nullptr)
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->Register(fEdep);
   accumulableManager->Register(fEdep2);
+
+  // 权窗生成模式（NGAMMA_WW_GENERATE）：各层各能群通量作为累积量合并
+  fWeightWindowGenerator.reset(WeightWindowGenerator::CreateFromEnvironment());
+  if (fWeightWindowGenerator) accumulableManager->Register(fWeightWindowGenerator.get());
+  // 径迹长度注量（按事件统计方差）
+  accumulableManager->Register(&fFluenceScorer.GetStatistics());
+  // 深度分辨透射（/scoring/depth/ 平面）
+  accumulableManager->Register(&fDepthScorer.GetStatistics());
+  // 积分计分量的按历史统计（均值、相对误差、FOM）
+  accumulableManager->Register(&fHistoryStatistics);
   
   // 获取分析管理器
   G4cout << "Attempting to get G4AnalysisManager instance..." << G4endl;
@@ -82,11 +118,78 @@ RunAction::RunAction() : fTrackTree(nullptr)
   }
   analysisManager->SetVerboseLevel(1);
   analysisManager->SetNtupleMerging(true);
+
+  // 直方图与Ntuple在构造时定义（master与worker线程一致），每个run只需重新打开文件
+  // 创建直方图
+  analysisManager->CreateH1("Edep", "Energy Deposition", 100, 0., 10.*MeV);
+  analysisManager->CreateH1("DPA", "Displacements Per Atom", 100, 0., 1.0);
+  analysisManager->CreateH1("NIEL", "Non-Ionizing Energy Loss", 100, 0., 1.*MeV);
+  // 透射与俘获诊断
+  analysisManager->CreateH1("Gamma_Transmit_E", "Gamma Transmission Energy", 200, 0., 10.*MeV);
+  analysisManager->CreateH1("Neutron_Transmit_E", "Neutron Transmission Energy", 200, 0., 20.*MeV);
+  analysisManager->CreateH1("Neutron_Capture_E", "Neutron Capture Energy (neutron pre-capture)", 200, 0., 20.*MeV);
+  analysisManager->CreateH1("Capture_Gamma_E", "Capture Gamma Energy", 400, 0., 10.*MeV);
+  analysisManager->CreateH1("Gamma_Incident_E", "Gamma Incident Energy", 200, 0., 10.*MeV);
+  analysisManager->CreateH1("Neutron_Incident_E", "Neutron Incident Energy", 200, 0., 20.*MeV);
+  analysisManager->CreateH1("Capture_Count", "Neutron Capture Count (per run)", 10, 0., 10.);
+  // 径迹长度注量（H2 0/1：区域 × 能量，run结束时由master填入每个源粒子的均值）
+  FluenceScorer::Book();
+  // 深度分辨透射（H2 2/3：平面 × 能量，H1 10：平面深度），同样由master在run结束时填入
+  DepthTransmissionScorer::Book();
+  // 响应矩阵（H2 4..6：E_in × E_out，H1 11：初级能量），用于离线谱折叠；
+  // 只在启用时定义（编号在最后，不影响其他直方图）
+  if (ResponseMatrix::Enabled()) ResponseMatrix::Book();
+ 
+  // 创建Ntuple
+  analysisManager->CreateNtuple("PhysicsData", "Physics Quantities");
+  analysisManager->CreateNtupleIColumn("EventID");
+  analysisManager->CreateNtupleDColumn("Edep");
+  analysisManager->CreateNtupleDColumn("X");
+  analysisManager->CreateNtupleDColumn("Y");
+  analysisManager->CreateNtupleDColumn("Z");
+  analysisManager->CreateNtupleDColumn("Weight");  // 初级权重（源偏倚）
+  analysisManager->FinishNtuple();
+  // ActivationProducts（简表）
+  analysisManager->CreateNtuple("ActivationProducts", "Capture simplified table");
+  analysisManager->CreateNtupleDColumn("PreNeutronE");
+  analysisManager->CreateNtupleDColumn("CaptureGammaE");
+  analysisManager->CreateNtupleDColumn("X");
+  analysisManager->CreateNtupleDColumn("Y");
+  analysisManager->CreateNtupleDColumn("Z");
+  analysisManager->CreateNtupleDColumn("Weight");  // 轨迹权重（重要性偏倚）
+  analysisManager->FinishNtuple();
+  // Damage类量（与光学无关）：DPA/NIEL
+  analysisManager->CreateNtuple("Damage", "Damage quantities (non-optical): DPA, NIEL");
+  analysisManager->CreateNtupleIColumn("EventID");
+  analysisManager->CreateNtupleDColumn("DPA");
+  analysisManager->CreateNtupleDColumn("NIEL");
+  analysisManager->CreateNtupleDColumn("Weight");  // 初级权重（源偏倚）
+  analysisManager->FinishNtuple();
+  
+  // 通过G4AnalysisManager创建轨迹数据的Ntuple
+  analysisManager->CreateNtuple("TrackData", "Particle Track Information");
+  analysisManager->CreateNtupleIColumn("TrackID");
+  analysisManager->CreateNtupleIColumn("ParentID");
+  analysisManager->CreateNtupleIColumn("PDGCode");
+  analysisManager->CreateNtupleDColumn("X");
+  analysisManager->CreateNtupleDColumn("Y");
+  analysisManager->CreateNtupleDColumn("Z");
+  analysisManager->CreateNtupleDColumn("KineticEnergy");
+  analysisManager->CreateNtupleDColumn("Time");
+  analysisManager->CreateNtupleIColumn("StepNumber");
+  analysisManager->CreateNtupleIColumn("EventID");
+  analysisManager->FinishNtuple();
+  
+
   G4cout << "G4AnalysisManager initialized successfully" << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+RunAction::~RunAction() = default;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void RunAction::BeginOfRunAction(const G4Run* run)
 {
   G4cout << "=== BeginOfRunAction: Starting run with " 
@@ -99,17 +202,36 @@ void RunAction::BeginOfRunAction(const G4Run* run)
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->Reset();
 
-  // 只在master线程中设置ROOT文件
+  const auto detConstruction = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  fFluenceScorer.BeginOfRun(detConstruction);
+  fDepthScorer.BeginOfRun(detConstruction);
+  fConvergenceMonitor.BeginOfRun(IsMaster());
+
+  if (fWeightWindowGenerator) {
+    // 网格覆盖玻璃（放置于原点）
+    G4double halfGlassZ = 0.5 * detConstruction->GetGlassSizeZ();
+    fWeightWindowGenerator->SetExtent(-halfGlassZ, halfGlassZ);
+  }
+
+  // 只在master线程中生成输出目录与文件名
   if (IsMaster()) {
-    // 创建输出文件
-    G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+    // 材料计分常数表与损伤函数网格：事件循环开始前构建，worker线程只读共享
+    MaterialScoringTable::Instance().Build();
+    DamageFunctionTable::Instance().Build();
+    // TrackData字节预算按本run的事件数分摊，每个run重新计
+    TrackSampler::ResetBudget(run->GetNumberOfEventToBeProcessed());
+
+    // 物理表此时已构建完毕：若启用了缓存且尚无缓存，写入以供后续进程读取
+    if (auto physList = dynamic_cast<CustomPhysicsList*>(
+          const_cast<G4VUserPhysicsList*>(G4RunManagerKernel::GetRunManagerKernel()->GetPhysicsList()))) {
+      physList->StorePhysicsTablesIfNeeded();
+    }
+
     // 生成包含源、事件数、时间戳的信息化输出路径，写到与build同级的data目录
     G4String particle = "unknown";
     G4String energyTag = "unknownE";
-    if (auto pga = dynamic_cast<const PrimaryGeneratorAction*>(G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction())) {
-      particle = pga->GetParticleTag();
-      energyTag = pga->GetSourceTag();
-    }
+    GetSourceTags(fMasterSource.get(), particle, energyTag);
     auto now = std::time(nullptr);
     std::tm tm{};
     #ifdef _WIN32
@@ -122,14 +244,27 @@ void RunAction::BeginOfRunAction(const G4Run* run)
     // 目录名顺序：粒子类型_能量_事件数_时间
     std::string folder = std::string(particle) + std::string("_") + energyTag +
                          std::string("_") + std::to_string(run->GetNumberOfEventToBeProcessed()) + std::string("ev_") + std::string(ts);
-    // 使用绝对基路径（可通过环境变量NGAMMA_DATA_DIR覆盖），每次扫描单独子目录
+    // 数据基路径：环境变量NGAMMA_DATA_DIR优先，缺省 $HOME/ngamma/data（与 tools/data_paths.py 相同），
+    // 每次扫描单独子目录
     const char* envBase = std::getenv("NGAMMA_DATA_DIR");
+    const char* envHome = std::getenv("HOME");
     std::filesystem::path baseDir = (envBase && envBase[0] != '\0')
                                       ? std::filesystem::path(envBase)
-                                      : std::filesystem::path("/home/jesse/ngamma/data");
-    std::filesystem::path outDir = baseDir / folder;
+                                      : std::filesystem::path((envHome && envHome[0] != '\0') ? envHome : ".")
+                                          / "ngamma" / "data";
+    // 运行目录索引与结果缓存按绝对路径匹配run目录：相对的 NGAMMA_DATA_DIR 按当前工作目录展开
     std::error_code ec;
-    std::filesystem::create_directories(outDir, ec);
+    std::filesystem::path absBase = std::filesystem::absolute(baseDir, ec);
+    if (!ec) baseDir = absBase;
+    ec.clear();
+    std::filesystem::path outDir = baseDir / folder;
+    std::filesystem::create_directories(baseDir, ec);
+    // 同一进程内连续的run（批处理服务模式）或同一秒启动的并行进程（job_scheduler.py）
+    // 可能得到同名目录：create_directory 原子占用，已存在时加run号与序号
+    for (G4int attempt = 1; !ec && !std::filesystem::create_directory(outDir, ec); ++attempt) {
+      outDir = baseDir / (folder + "_run" + std::to_string(run->GetRunID()) +
+                          (attempt > 1 ? "_" + std::to_string(attempt) : std::string()));
+    }
     if (ec) {
       G4cerr << "WARNING: Failed to create output directory: " << outDir.string() << G4endl;
     }
@@ -211,69 +346,33 @@ void RunAction::BeginOfRunAction(const G4Run* run)
     } catch (...) {
       G4cerr << "WARNING: Failed to write composition.txt" << G4endl;
     }
+    if (fPhaseSpaceWriter.IsEnabled()) {
+      PhaseSpaceWriter::OpenShared((outDir / "phasespace.phsp").string());
+    }
     G4String fileName = outFile.string();
     G4cout << "Creating ROOT file: " << fileName << G4endl;
-    
-    try {
-      analysisManager->OpenFile(fileName);
-      
-      // 创建直方图
-      analysisManager->CreateH1("Edep", "Energy Deposition", 100, 0., 10.*MeV);
-      analysisManager->CreateH1("DPA", "Displacements Per Atom", 100, 0., 1.0);
-      analysisManager->CreateH1("NIEL", "Non-Ionizing Energy Loss", 100, 0., 1.*MeV);
-      // 透射与俘获诊断
-      analysisManager->CreateH1("Gamma_Transmit_E", "Gamma Transmission Energy", 200, 0., 10.*MeV);
-      analysisManager->CreateH1("Neutron_Transmit_E", "Neutron Transmission Energy", 200, 0., 20.*MeV);
-      analysisManager->CreateH1("Neutron_Capture_E", "Neutron Capture Energy (neutron pre-capture)", 200, 0., 20.*MeV);
-      analysisManager->CreateH1("Capture_Gamma_E", "Capture Gamma Energy", 400, 0., 10.*MeV);
-      analysisManager->CreateH1("Gamma_Incident_E", "Gamma Incident Energy", 200, 0., 10.*MeV);
-      analysisManager->CreateH1("Neutron_Incident_E", "Neutron Incident Energy", 200, 0., 20.*MeV);
-      analysisManager->CreateH1("Capture_Count", "Neutron Capture Count (per run)", 10, 0., 10.);
- 
-      // 创建Ntuple
-      analysisManager->CreateNtuple("PhysicsData", "Physics Quantities");
-      analysisManager->CreateNtupleIColumn("EventID");
-      analysisManager->CreateNtupleDColumn("Edep");
-      analysisManager->CreateNtupleDColumn("X");
-      analysisManager->CreateNtupleDColumn("Y");
-      analysisManager->CreateNtupleDColumn("Z");
-      analysisManager->FinishNtuple();
-      // ActivationProducts（简表）
-      analysisManager->CreateNtuple("ActivationProducts", "Capture simplified table");
-      analysisManager->CreateNtupleDColumn("PreNeutronE");
-      analysisManager->CreateNtupleDColumn("CaptureGammaE");
-      analysisManager->CreateNtupleDColumn("X");
-      analysisManager->CreateNtupleDColumn("Y");
-      analysisManager->CreateNtupleDColumn("Z");
-      analysisManager->FinishNtuple();
-      // Damage类量（与光学无关）：DPA/NIEL
-      analysisManager->CreateNtuple("Damage", "Damage quantities (non-optical): DPA, NIEL");
-      analysisManager->CreateNtupleIColumn("EventID");
-      analysisManager->CreateNtupleDColumn("DPA");
-      analysisManager->CreateNtupleDColumn("NIEL");
-      analysisManager->FinishNtuple();
-      
-      // 通过G4AnalysisManager创建轨迹数据的Ntuple
-      analysisManager->CreateNtuple("TrackData", "Particle Track Information");
-      analysisManager->CreateNtupleIColumn("TrackID");
-      analysisManager->CreateNtupleIColumn("ParentID");
-      analysisManager->CreateNtupleIColumn("PDGCode");
-      analysisManager->CreateNtupleDColumn("X");
-      analysisManager->CreateNtupleDColumn("Y");
-      analysisManager->CreateNtupleDColumn("Z");
-      analysisManager->CreateNtupleDColumn("KineticEnergy");
-      analysisManager->CreateNtupleDColumn("Time");
-      analysisManager->CreateNtupleIColumn("StepNumber");
-      analysisManager->FinishNtuple();
-      
-      // 不再需要手动创建TTree
-      fTrackTree = nullptr;
-      
-      G4cout << "Analysis setup completed (including TrackData TTree)" << G4endl;
-    } catch (...) {
-      G4cerr << "ERROR: Exception during ROOT analysis setup!" << G4endl;
+    {
+      G4AutoLock lock(&outputFileMutex);
+      sharedOutputFileName = fileName;
     }
   }
+
+  // 所有线程打开同一输出文件（worker的直方图/ntuple在写出时合并到master）
+  G4String fileName;
+  {
+    G4AutoLock lock(&outputFileMutex);
+    fileName = sharedOutputFileName;
+  }
+  try {
+    G4AnalysisManager::Instance()->OpenFile(fileName);
+    fScoringBuffer.Bind();
+    // 不再需要手动创建TTree
+    fTrackTree = nullptr;
+
+    if (IsMaster()) G4cout << "Analysis setup completed (including TrackData TTree)" << G4endl;
+  } catch (...) {
+    G4cerr << "ERROR: Exception during ROOT analysis setup!" << G4endl;
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -281,9 +380,26 @@ void RunAction::BeginOfRunAction(const G4Run* run)
 void RunAction::EndOfRunAction(const G4Run* run)
 {
   G4cout << "=== EndOfRunAction: Processing run results ===" << G4endl;
+
+  // 把本线程剩余的缓冲内容写入分析管理器（须在Write之前）
+  fScoringBuffer.Flush();
+  // 相空间：worker写完剩余记录，master（最后结束）补写头部并关闭
+  fPhaseSpaceWriter.Flush();
+  if (IsMaster()) PhaseSpaceWriter::CloseShared(run->GetNumberOfEvent());
   
   G4int nofEvents = run->GetNumberOfEvent();
-  if (nofEvents == 0) return;
+  if (nofEvents == 0) {
+    // 没分到事件的线程同样在BeginOfRunAction打开了共享输出文件：照常Write/CloseFile
+    // 参与合并后再返回（事件少、线程多时常见）
+    try {
+      G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+      analysisManager->Write();
+      analysisManager->CloseFile();
+    } catch (...) {
+      G4cerr << "ERROR: Exception while closing ROOT file!" << G4endl;
+    }
+    return;
+  }
 
   // Merge accumulables
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
@@ -331,20 +447,55 @@ void RunAction::EndOfRunAction(const G4Run* run)
      << G4endl;
   }
   
-  // 只在master线程写入文件
+  G4double runCpu = 0.;
   if (IsMaster()) {
-    try {
-      G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
-      G4cout << "Writing ROOT file..." << G4endl;
-      
-      analysisManager->Write();
-      
-      G4String closed = analysisManager->GetFileName();
-      analysisManager->CloseFile();
+    TrackSampler::PrintSummary();
+    if (fWeightWindowGenerator) fWeightWindowGenerator->WriteWindows();
+    G4String outputFile;
+    {
+      G4AutoLock lock(&outputFileMutex);
+      outputFile = sharedOutputFileName;
+    }
+    fFluenceScorer.Report(nofEvents, std::filesystem::path(outputFile).parent_path().string());
+    fDepthScorer.Report(nofEvents, std::filesystem::path(outputFile).parent_path().string());
+    // 两份报告用同一份合并后的统计与同一个CPU时间，FOM一致
+    runCpu = ConvergenceMonitor::CpuSeconds();
+    fConvergenceMonitor.Report(std::filesystem::path(outputFile).parent_path().string(), fHistoryStatistics,
+                               nofEvents, runCpu);
+    ReportHistoryStatistics(nofEvents, std::filesystem::path(outputFile).parent_path().string(), runCpu);
+  }
+
+  // 所有线程都需Write/CloseFile：worker在此把数据合并到master，master最终写出文件
+  try {
+    G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+    if (IsMaster()) G4cout << "Writing ROOT file..." << G4endl;
+
+    analysisManager->Write();
+
+    G4String closed = analysisManager->GetFileName();
+    analysisManager->CloseFile();
+    if (IsMaster()) {
       G4cout << "Analysis results written to " << closed << G4endl;
-    } catch (...) {
-      G4cerr << "ERROR: Exception during ROOT file writing!" << G4endl;
+      // 元数据最后写出：存在即表示本run的输出完整（结果缓存据此复用）
+      fRunConfiguration.WriteMetadata(run, std::filesystem::path(closed).parent_path().string(),
+                                      ConvergenceMonitor::StopReason());
+
+      // 运行目录索引：元数据 + 源 + 积分计分量，供 tools/run_catalog.py 查询
+      RunConfiguration::Summary summary;
+      summary.particle = "unknown";
+      summary.source = "unknown";
+      GetSourceTags(fMasterSource.get(), summary.particle, summary.source);
+      summary.cpuSeconds = runCpu;
+      summary.dose = dose;
+      summary.doseRms = rmsDose;
+      for (G4int t = 0; t < ConvergenceMonitor::kNumTallies; ++t) {
+        summary.tallies.emplace_back(ConvergenceMonitor::TallyName(t), fHistoryStatistics.Mean(t, nofEvents),
+                                     fHistoryStatistics.RelativeError(t, nofEvents));
+      }
+      fRunConfiguration.AppendToCatalog(run, std::filesystem::path(closed).parent_path().string(), summary);
     }
+  } catch (...) {
+    G4cerr << "ERROR: Exception during ROOT file writing!" << G4endl;
   }
 }
 
@@ -358,22 +509,54 @@ void RunAction::AddEdep(G4double edep)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::FillTrackData(G4int trackID, G4int parentID, G4int pdgCode, 
-                              G4double x, G4double y, G4double z, 
-                              G4double kineticEnergy, G4double time, G4int stepNumber)
+void RunAction::ReportHistoryStatistics(G4int nEvents, const G4String& outputDir, G4double cpu) const
+{
+  // FOM = 1/(R^2 T)，T 为本run的进程CPU时间（分钟，所有线程合计），用于比较物理/截断设置的效率
+  const G4double n = nEvents;
+  const G4double minutes = cpu / 60.;
+
+  std::ofstream fout((std::filesystem::path(outputDir) / "tally_statistics.txt").string());
+  if (fout.good()) {
+    fout << "# per-history statistics; events = " << nEvents << "; cpu_s = " << cpu << "\n";
+    fout << "# tally mean_per_history rel_err fom_per_min\n";
+  }
+
+  G4cout << G4endl << "--------------------Tally statistics (per history)--------------------" << G4endl;
+  for (G4int t = 0; t < ConvergenceMonitor::kNumTallies; ++t) {
+    G4double mean = fHistoryStatistics.Mean(t, n);
+    G4double r = fHistoryStatistics.RelativeError(t, n);
+    G4double fom = (r > 0. && minutes > 0.) ? 1. / (r * r * minutes) : 0.;
+    // MCNP经验：R < 0.05 可靠，0.05～0.1 可用，> 0.1 不可信
+    const char* quality = (r <= 0.) ? "no score" : (r < 0.05) ? "" : (r < 0.1) ? "marginal" : "unreliable";
+    G4cout << " " << std::setw(28) << std::left << ConvergenceMonitor::TallyTitle(t) << std::right
+           << " mean = " << std::setprecision(5) << mean << "  R = " << r << "  FOM = " << fom
+           << "  " << quality << G4endl;
+    if (fout.good()) {
+      fout << ConvergenceMonitor::TallyName(t) << " " << std::scientific << mean << " " << r << " "
+           << fom << std::defaultfloat << "\n";
+    }
+  }
+  G4cout << " CPU time " << cpu << " s" << G4endl;
+  G4cout << "----------------------------------------------------------------------" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::FillTrackData(G4int eventID, const TrackSampler::Record& rec)
 {
   // 使用G4AnalysisManager填充轨迹数据（Ntuple ID = 3）
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
   if (analysisManager) {
-    analysisManager->FillNtupleIColumn(3, 0, trackID);
-    analysisManager->FillNtupleIColumn(3, 1, parentID);
-    analysisManager->FillNtupleIColumn(3, 2, pdgCode);
-    analysisManager->FillNtupleDColumn(3, 3, x);
-    analysisManager->FillNtupleDColumn(3, 4, y);
-    analysisManager->FillNtupleDColumn(3, 5, z);
-    analysisManager->FillNtupleDColumn(3, 6, kineticEnergy);
-    analysisManager->FillNtupleDColumn(3, 7, time);
-    analysisManager->FillNtupleIColumn(3, 8, stepNumber);
+    analysisManager->FillNtupleIColumn(3, 0, rec.trackID);
+    analysisManager->FillNtupleIColumn(3, 1, rec.parentID);
+    analysisManager->FillNtupleIColumn(3, 2, rec.pdgCode);
+    analysisManager->FillNtupleDColumn(3, 3, rec.x);
+    analysisManager->FillNtupleDColumn(3, 4, rec.y);
+    analysisManager->FillNtupleDColumn(3, 5, rec.z);
+    analysisManager->FillNtupleDColumn(3, 6, rec.kineticEnergy);
+    analysisManager->FillNtupleDColumn(3, 7, rec.time);
+    analysisManager->FillNtupleIColumn(3, 8, rec.stepNumber);
+    analysisManager->FillNtupleIColumn(3, 9, eventID);
     analysisManager->AddNtupleRow(3);
   }
 }
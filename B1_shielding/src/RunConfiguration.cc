@@ -0,0 +1,315 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/RunConfiguration.cc
+/// \brief Implementation of the B1::RunConfiguration class
+
+#include "RunConfiguration.hh"
+#include "DetectorConstruction.hh"
+#include "HashUtil.hh"
+
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4RunManagerKernel.hh"
+#include "G4VUserPhysicsList.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4UImanager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace B1
+{
+
+namespace {
+  // 影响物理结果的环境变量（线程数、输出目录、物理表缓存等不影响结果，不计入）
+  const char* kPhysicsEnv[] = {
+    "EM_PHYSICS_OPTION", "NGAMMA_SOURCE_MODE", "NGAMMA_SRIM_ED_FILE",
+    "NGAMMA_IMPORTANCE_LAYERS", "NGAMMA_IMPORTANCE_VALUES", "NGAMMA_IMPORTANCE_BASE",
+    "NGAMMA_BIAS_PARTICLES", "NGAMMA_WW_FILE", "NGAMMA_RESPONSE_MATRIX"};
+
+  // 只影响输出/显示/随机数/事件数的命令：不计入配置哈希
+  const char* kIgnoredPrefixes[] = {
+    "/control/", "/random/", "/vis/", "/tracking/", "/event/verbose", "/run/verbose",
+    "/run/printProgress", "/run/beamOn", "/run/initialize", "/run/physicsModified", "/run/geometryModified",
+    "/tracks/", "/phsp/", "/metadata/",
+    "/scoring/convergence/", "/scoring/flushInterval", "/det/glass/compositionFile"};
+
+  // 空白规范化：去首尾空白，连续空白合并为一个空格
+  G4String NormalizeCommand(const G4String& command)
+  {
+    std::istringstream iss(command);
+    std::string token, out;
+    while (iss >> token) {
+      if (!out.empty()) out += ' ';
+      out += token;
+    }
+    return out;
+  }
+
+  std::string JsonEscape(const std::string& text)
+  {
+    std::string out;
+    for (char c : text) {
+      if (c == '"' || c == '\\') { out += '\\'; out += c; continue; }
+      if (c == '\n') { out += "\\n"; continue; }
+      if (c == '\t') { out += "\\t"; continue; }
+      if (c == '\r') { out += "\\r"; continue; }
+      // 其余控制字符（JSON不允许直接出现）
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(c)));
+        out += buf;
+        continue;
+      }
+      out += c;
+    }
+    return out;
+  }
+}
+
+G4int RunConfiguration::fSetupHistoryEnd = -1;
+G4int RunConfiguration::fJobHistoryStart = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunConfiguration::RunConfiguration()
+{
+  fMessenger = new G4GenericMessenger(this, "/metadata/", "Run metadata for the result cache");
+  fMessenger->DeclareProperty("jobKey", fJobKey)
+            .SetGuidance("External job key recorded in run_metadata.json (set by tools/result_cache.py)");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunConfiguration::~RunConfiguration()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunConfiguration::MarkSetupEnd()
+{
+  fSetupHistoryEnd = G4UImanager::GetUIpointer()->GetNumberOfHistory();
+  fJobHistoryStart = fSetupHistoryEnd;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunConfiguration::MarkJobStart()
+{
+  fJobHistoryStart = G4UImanager::GetUIpointer()->GetNumberOfHistory();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4String> RunConfiguration::CanonicalLines()
+{
+  std::vector<G4String> lines;
+  std::ostringstream oss;
+
+  const auto detector = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  if (detector && detector->GetScoringVolume()) {
+    // 材料名含规范化配方哈希（见 GlassMaterialRegistry）
+    lines.push_back("glass=" + detector->GetScoringVolume()->GetMaterial()->GetName());
+    oss << "glassThickness_mm=" << detector->GetGlassSizeZ() / mm;
+    lines.push_back(oss.str());
+  }
+  if (auto physList = G4RunManagerKernel::GetRunManagerKernel()->GetPhysicsList()) {
+    oss.str("");
+    oss << "defaultCut_mm=" << physList->GetDefaultCutValue() / mm;
+    lines.push_back(oss.str());
+  }
+  for (const char* name : kPhysicsEnv) {
+    const char* value = std::getenv(name);
+    lines.push_back(G4String("env:") + name + "=" + (value ? value : ""));
+  }
+
+  // UI历史按执行顺序（宏内各行也逐条记录）；历史长度在 main 中放开
+  auto UImanager = G4UImanager::GetUIpointer();
+  for (G4int i = 0; i < UImanager->GetNumberOfHistory(); ++i) {
+    if (fSetupHistoryEnd >= 0 && i >= fSetupHistoryEnd && i < fJobHistoryStart) continue;
+    G4String command = NormalizeCommand(UImanager->GetPreviousCommand(i));
+    if (command.empty()) continue;
+    G4bool ignored = false;
+    for (const char* prefix : kIgnoredPrefixes) {
+      if (command.compare(0, std::char_traits<char>::length(prefix), prefix) == 0) { ignored = true; break; }
+    }
+    if (!ignored) lines.push_back("cmd:" + command);
+  }
+  return lines;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String RunConfiguration::ConfigHash(const std::vector<G4String>& lines)
+{
+  std::string canonical;
+  for (const auto& line : lines) canonical += line + "\n";
+  return HashToHex(Fnv1a64(canonical));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String RunConfiguration::CurrentSeeds()
+{
+  // 最后一次 /random/setSeeds；没有时为引擎缺省种子（同一程序的所有run相同）
+  G4String seeds = "default";
+  auto UImanager = G4UImanager::GetUIpointer();
+  for (G4int i = 0; i < UImanager->GetNumberOfHistory(); ++i) {
+    G4String command = NormalizeCommand(UImanager->GetPreviousCommand(i));
+    if (command.compare(0, 17, "/random/setSeeds ") == 0) seeds = command.substr(17);
+  }
+  return seeds;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunConfiguration::WriteMetadata(const G4Run* run, const G4String& outputDir,
+                                     const G4String& stopReason) const
+{
+  std::vector<G4String> lines = CanonicalLines();
+  G4String seeds = CurrentSeeds();
+  G4String reason = stopReason;
+  if (reason == "beamOn_limit" && run->GetNumberOfEvent() < run->GetNumberOfEventToBeProcessed()) {
+    reason = "aborted";
+  }
+
+  std::ofstream fout((std::filesystem::path(outputDir) / "run_metadata.json").string());
+  if (!fout.good()) {
+    G4cerr << "WARNING: Failed to write run_metadata.json" << G4endl;
+    return;
+  }
+  fout << "{\n"
+       << "  \"config_hash\": \"" << ConfigHash(lines) << "\",\n"
+       << "  \"job_key\": \"" << JsonEscape(fJobKey) << "\",\n"
+       << "  \"events\": " << run->GetNumberOfEvent() << ",\n"
+       << "  \"events_requested\": " << run->GetNumberOfEventToBeProcessed() << ",\n"
+       << "  \"stop_reason\": \"" << reason << "\",\n"
+       << "  \"seeds\": \"" << JsonEscape(seeds) << "\",\n"
+       << "  \"run_id\": " << run->GetRunID() << ",\n"
+       << "  \"threads\": " << G4RunManager::GetRunManager()->GetNumberOfThreads() << ",\n"
+       << "  \"config\": [\n";
+  for (std::size_t i = 0; i < lines.size(); ++i) {
+    fout << "    \"" << JsonEscape(lines[i]) << "\"" << (i + 1 < lines.size() ? "," : "") << "\n";
+  }
+  fout << "  ]\n}\n";
+  G4cout << "[metadata] config_hash = " << ConfigHash(lines) << ", seeds = " << seeds << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunConfiguration::AppendToCatalog(const G4Run* run, const G4String& outputDir, const Summary& summary) const
+{
+  std::filesystem::path dir(outputDir);
+  const auto detector = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  const G4Material* material = (detector && detector->GetScoringVolume())
+                                 ? detector->GetScoringVolume()->GetMaterial() : nullptr;
+
+  auto now = std::time(nullptr);
+  std::tm tm{};
+  #ifdef _WIN32
+    localtime_s(&tm, &now);
+  #else
+    localtime_r(&now, &tm);
+  #endif
+  char ts[32];
+  std::strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", &tm);
+
+  // 一条记录一行JSON
+  std::ostringstream oss;
+  oss << std::setprecision(9)
+      << "{\"time\": \"" << ts << "\""
+      << ", \"dir\": \"" << JsonEscape(dir.string()) << "\""
+      << ", \"root_file\": \"" << JsonEscape((dir / "scintillator_output.root").string()) << "\""
+      << ", \"run_id\": " << run->GetRunID()
+      << ", \"events\": " << run->GetNumberOfEvent()
+      << ", \"events_requested\": " << run->GetNumberOfEventToBeProcessed()
+      << ", \"threads\": " << G4RunManager::GetRunManager()->GetNumberOfThreads()
+      << ", \"particle\": \"" << JsonEscape(summary.particle) << "\""
+      << ", \"source\": \"" << JsonEscape(summary.source) << "\""
+      << ", \"material\": \"" << (material ? JsonEscape(material->GetName()) : std::string()) << "\""
+      << ", \"density_g_cm3\": " << (material ? material->GetDensity() / (g/cm3) : 0.)
+      << ", \"recipe_file\": \"" << (detector ? JsonEscape(detector->GetGlassCompositionFile()) : std::string()) << "\""
+      << ", \"glass_thickness_mm\": " << (detector ? detector->GetGlassSizeZ() / mm : 0.)
+      << ", \"config_hash\": \"" << ConfigHash(CanonicalLines()) << "\""
+      << ", \"job_key\": \"" << JsonEscape(fJobKey) << "\""
+      << ", \"seeds\": \"" << JsonEscape(CurrentSeeds()) << "\""
+      << ", \"cpu_s\": " << summary.cpuSeconds
+      << ", \"dose_Gy\": " << summary.dose / gray
+      << ", \"dose_rms_Gy\": " << summary.doseRms / gray
+      << ", \"tallies\": {";
+  for (std::size_t i = 0; i < summary.tallies.size(); ++i) {
+    const auto& [name, mean, relErr] = summary.tallies[i];
+    oss << (i ? ", " : "") << "\"" << JsonEscape(name) << "\": [" << mean << ", " << relErr << "]";
+  }
+  oss << "}}\n";
+  const std::string line = oss.str();
+
+  const std::string catalog = (dir.parent_path() / "run_catalog.jsonl").string();
+#ifndef _WIN32
+  // 并行进程（job_scheduler.py）可能同时追加：flock 互斥，单次 write 写完整行
+  int fd = ::open(catalog.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+  G4bool ok = (fd >= 0);
+  if (ok) {
+    ::flock(fd, LOCK_EX);
+    ok = (::write(fd, line.data(), line.size()) == static_cast<ssize_t>(line.size()));
+    ::flock(fd, LOCK_UN);
+    ::close(fd);
+  }
+#else
+  std::ofstream fout(catalog, std::ios::app);
+  fout << line;
+  G4bool ok = fout.good();
+#endif
+  if (!ok) {
+    G4cerr << "WARNING: Failed to append to run catalog " << catalog << G4endl;
+    return;
+  }
+  G4cout << "[catalog] appended run to " << catalog << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
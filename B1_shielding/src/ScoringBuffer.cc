@@ -0,0 +1,155 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/ScoringBuffer.cc
+/// \brief Implementation of the B1::ScoringBuffer class
+
+#include "ScoringBuffer.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4GenericMessenger.hh"
+#include "tools/histo/h1d"
+#include "tools/histo/h2d"
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ScoringBuffer::ScoringBuffer()
+{
+  fMessenger = new G4GenericMessenger(this, "/scoring/", "Scoring buffer control");
+  fMessenger->DeclareProperty("flushInterval", fFlushInterval)
+            .SetGuidance("Merge buffered histogram fills/capture records every N events (default 1000)")
+            .SetGuidance("Merging costs only the fills recorded since the last merge; larger N needs more memory")
+            .SetParameterName("N", false)
+            .SetRange("N>=1");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ScoringBuffer::~ScoringBuffer()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScoringBuffer::Bind()
+{
+  fTargetH1.clear();
+  fTargetH2.clear();
+  fFillsH1.clear();
+  fFillsH2.clear();
+  fCaptures.clear();
+  fEventsSinceFlush = 0;
+
+  // 未预定义的直方图（如非response模式下的响应矩阵）记为空指针，填充时跳过
+  auto analysisManager = G4AnalysisManager::Instance();
+  for (G4int id = kFirstH1; id <= kLastH1; ++id) {
+    fTargetH1.push_back(analysisManager->GetH1(id, false));
+  }
+  for (G4int id = kFirstH2; id <= kLastH2; ++id) {
+    fTargetH2.push_back(analysisManager->GetH2(id, false));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScoringBuffer::FillH1(G4int id, G4double value, G4double weight)
+{
+  std::size_t slot = id - kFirstH1;
+  if (slot < fTargetH1.size()) {
+    if (fTargetH1[slot]) fFillsH1.push_back({static_cast<G4int>(slot), value, 0., weight});
+  }
+  else {
+    // 不在缓冲区间内时直接交给分析管理器
+    G4AnalysisManager::Instance()->FillH1(id, value, weight);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScoringBuffer::FillH2(G4int id, G4double xValue, G4double yValue, G4double weight)
+{
+  // 响应矩阵以 "MeV" 为单位预定义，MeV 即内部单位，数值无需换算
+  std::size_t slot = id - kFirstH2;
+  if (slot < fTargetH2.size()) {
+    if (fTargetH2[slot]) fFillsH2.push_back({static_cast<G4int>(slot), xValue, yValue, weight});
+  }
+  else {
+    G4AnalysisManager::Instance()->FillH2(id, xValue, yValue, weight);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScoringBuffer::AddCapture(G4double preNeutronE, G4double captureGammaE,
+                               const G4ThreeVector& position, G4double weight)
+{
+  fCaptures.push_back({preNeutronE, captureGammaE, position, weight});
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScoringBuffer::EndOfEvent()
+{
+  if (++fEventsSinceFlush >= fFlushInterval) Flush();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScoringBuffer::Flush()
+{
+  fEventsSinceFlush = 0;
+
+  // 按记录顺序填入目标直方图：只触及被填过的箱
+  for (const auto& fill : fFillsH1) {
+    fTargetH1[fill.slot]->fill(fill.x, fill.weight);
+  }
+  fFillsH1.clear();
+  for (const auto& fill : fFillsH2) {
+    fTargetH2[fill.slot]->fill(fill.x, fill.y, fill.weight);
+  }
+  fFillsH2.clear();
+
+  if (fCaptures.empty()) return;
+  auto analysisManager = G4AnalysisManager::Instance();
+  for (const auto& rec : fCaptures) {
+    analysisManager->FillNtupleDColumn(1, 0, rec.preNeutronE);   // ActivationProducts.PreNeutronE
+    analysisManager->FillNtupleDColumn(1, 1, rec.captureGammaE); // CaptureGammaE
+    analysisManager->FillNtupleDColumn(1, 2, rec.position.x());
+    analysisManager->FillNtupleDColumn(1, 3, rec.position.y());
+    analysisManager->FillNtupleDColumn(1, 4, rec.position.z());
+    analysisManager->FillNtupleDColumn(1, 5, rec.weight);
+    analysisManager->AddNtupleRow(1);
+  }
+  fCaptures.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
@@ -0,0 +1,159 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/TabulatedSpectrum.cc
+/// \brief Implementation of the B1::TabulatedSpectrum class
+
+#include "TabulatedSpectrum.hh"
+
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TabulatedSpectrum::Load(const G4String& fileName, G4int nBins)
+{
+  std::ifstream fin(fileName);
+  if (!fin.good()) {
+    G4cerr << "[spectrum] Cannot open " << fileName << G4endl;
+    return false;
+  }
+  std::vector<G4double> energies, density;
+  std::string line;
+  while (std::getline(fin, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream iss(line);
+    G4double e, w;
+    if (iss >> e >> w) {
+      energies.push_back(e);
+      density.push_back(std::max(w, 0.));
+    }
+  }
+  if (!Build(energies, density, nBins)) {
+    G4cerr << "[spectrum] No usable points in " << fileName << G4endl;
+    return false;
+  }
+  G4cout << "[spectrum] Loaded " << energies.size() << " points from " << fileName
+         << " into " << fProb.size() << " alias bins (" << fEdges.front() << " - "
+         << fEdges.back() << " MeV)" << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TabulatedSpectrum::Build(const std::vector<G4double>& energies, const std::vector<G4double>& density,
+                                G4int nBins)
+{
+  if (energies.size() < 2 || energies.size() != density.size() || nBins < 1) return false;
+  if (!std::is_sorted(energies.begin(), energies.end()) || energies.front() <= 0.) return false;
+
+  // 细对数网格，箱概率 = 中心处线性插值密度 × 箱宽
+  const G4double eMin = energies.front(), eMax = energies.back();
+  const G4double logRatio = std::log(eMax / eMin);
+  std::vector<G4double> edges(nBins + 1);
+  for (G4int i = 0; i <= nBins; ++i) edges[i] = eMin * std::exp(logRatio * i / nBins);
+  edges.back() = eMax;
+
+  std::vector<G4double> mass(nBins);
+  G4double total = 0.;
+  for (G4int i = 0; i < nBins; ++i) {
+    G4double center = 0.5 * (edges[i] + edges[i + 1]);
+    std::size_t k = std::upper_bound(energies.begin(), energies.end(), center) - energies.begin();
+    k = std::clamp<std::size_t>(k, 1, energies.size() - 1);
+    G4double span = energies[k] - energies[k - 1];
+    G4double t = (span > 0.) ? (center - energies[k - 1]) / span : 0.;
+    mass[i] = std::max(density[k - 1] + t * (density[k] - density[k - 1]), 0.) * (edges[i + 1] - edges[i]);
+    total += mass[i];
+  }
+  if (total <= 0.) return false;
+
+  // Vose 别名表：把 n*p_i 分为小于1与不小于1两组，逐对配平
+  std::vector<G4double> prob(nBins);
+  std::vector<G4int> alias(nBins, 0);
+  std::vector<G4double> scaled(nBins);
+  std::vector<G4int> small, large;
+  for (G4int i = 0; i < nBins; ++i) {
+    scaled[i] = mass[i] / total * nBins;
+    (scaled[i] < 1. ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    G4int s = small.back(); small.pop_back();
+    G4int l = large.back(); large.pop_back();
+    prob[s] = scaled[s];
+    alias[s] = l;
+    scaled[l] = (scaled[l] + scaled[s]) - 1.;
+    (scaled[l] < 1. ? small : large).push_back(l);
+  }
+  // 剩余项（含舍入误差）概率为1
+  for (G4int i : large) prob[i] = 1.;
+  for (G4int i : small) prob[i] = 1.;
+
+  fEdges.swap(edges);
+  fProb.swap(prob);
+  fAlias.swap(alias);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TabulatedSpectrum::Sample() const
+{
+  const G4int n = static_cast<G4int>(fProb.size());
+  G4double u = G4UniformRand() * n;
+  G4int bin = std::min(static_cast<G4int>(u), n - 1);
+  // u 的小数部分与本箱接受概率比较，省去一个随机数
+  if (u - bin >= fProb[bin]) bin = fAlias[bin];
+  return fEdges[bin] + G4UniformRand() * (fEdges[bin + 1] - fEdges[bin]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TabulatedSpectrum::SampleWatt(G4double a, G4double b, G4double eMin, G4double eMax)
+{
+  // 先按温度a的Maxwell谱抽 w = -a (ln r1 + ln r2 cos^2(pi r3/2))，
+  // 再平移 E = w + a^2 b/4 + (2 r4 - 1) sqrt(a^2 b w)，即为精确的Watt分布；
+  // 截断区间外（Cf-252 在 12 MeV 以上不到千分之一）重抽，区间内形状不变
+  const G4double a2b = a * a * b;
+  G4double energy;
+  do {
+    const G4double c = std::cos(0.5 * CLHEP::pi * G4UniformRand());
+    const G4double w = -a * (std::log(1. - G4UniformRand()) + std::log(1. - G4UniformRand()) * c * c);
+    energy = w + 0.25 * a2b + (2. * G4UniformRand() - 1.) * std::sqrt(a2b * w);
+  } while (energy < eMin || energy > eMax);
+  return energy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
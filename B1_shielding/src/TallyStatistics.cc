@@ -0,0 +1,151 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/TallyStatistics.cc
+/// \brief Implementation of the B1::TallyStatistics class
+
+#include "TallyStatistics.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TallyStatistics::TallyStatistics(const G4String& name, std::size_t nBins)
+  : G4VAccumulable(name),
+    fSum(nBins, 0.), fSum2(nBins, 0.), fSum3(nBins, 0.), fSum4(nBins, 0.), fScratch(nBins, 0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyStatistics::Score(std::size_t bin, G4double value)
+{
+  if (bin >= fScratch.size() || value == 0.) return;
+  if (fScratch[bin] == 0.) fTouched.push_back(bin);
+  fScratch[bin] += value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyStatistics::EndOfHistory()
+{
+  for (std::size_t bin : fTouched) {
+    G4double x = fScratch[bin];
+    G4double x2 = x * x;
+    fSum[bin] += x;
+    fSum2[bin] += x2;
+    fSum3[bin] += x2 * x;
+    fSum4[bin] += x2 * x2;
+    fScratch[bin] = 0.;
+  }
+  fTouched.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TallyStatistics::Mean(std::size_t bin, G4double nHistories) const
+{
+  return (nHistories > 0.) ? fSum[bin] / nHistories : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TallyStatistics::RelativeError(std::size_t bin, G4double nHistories) const
+{
+  if (nHistories <= 1. || fSum[bin] <= 0.) return 0.;
+  G4double mean = fSum[bin] / nHistories;
+  G4double variance = (fSum2[bin] / nHistories - mean * mean) / (nHistories - 1.);
+  return (variance > 0.) ? std::sqrt(variance) / mean : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TallyStatistics::VarianceOfVariance(std::size_t bin, G4double nHistories) const
+{
+  if (nHistories <= 1. || fSum[bin] <= 0.) return 0.;
+  G4double m = fSum[bin] / nHistories;
+  G4double central2 = fSum2[bin] - nHistories * m * m;
+  if (central2 <= 0.) return 0.;
+  G4double central4 = fSum4[bin] - 4. * m * fSum3[bin] + 6. * m * m * fSum2[bin]
+                      - 3. * nHistories * m * m * m * m;
+  return central4 / (central2 * central2) - 1. / nHistories;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyStatistics::Merge(const G4VAccumulable& other)
+{
+  const auto& rhs = static_cast<const TallyStatistics&>(other);
+  std::size_t n = std::min(fSum.size(), rhs.fSum.size());
+  for (std::size_t i = 0; i < n; ++i) {
+    fSum[i] += rhs.fSum[i];
+    fSum2[i] += rhs.fSum2[i];
+    fSum3[i] += rhs.fSum3[i];
+    fSum4[i] += rhs.fSum4[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyStatistics::Reset()
+{
+  std::fill(fSum.begin(), fSum.end(), 0.);
+  std::fill(fSum2.begin(), fSum2.end(), 0.);
+  std::fill(fSum3.begin(), fSum3.end(), 0.);
+  std::fill(fSum4.begin(), fSum4.end(), 0.);
+  std::fill(fScratch.begin(), fScratch.end(), 0.);
+  fTouched.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyStatistics::AddDifference(const TallyStatistics& current, const TallyStatistics& previous)
+{
+  std::size_t n = std::min({fSum.size(), current.fSum.size(), previous.fSum.size()});
+  for (std::size_t i = 0; i < n; ++i) {
+    fSum[i] += current.fSum[i] - previous.fSum[i];
+    fSum2[i] += current.fSum2[i] - previous.fSum2[i];
+    fSum3[i] += current.fSum3[i] - previous.fSum3[i];
+    fSum4[i] += current.fSum4[i] - previous.fSum4[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyStatistics::CopySums(const TallyStatistics& other)
+{
+  fSum = other.fSum;
+  fSum2 = other.fSum2;
+  fSum3 = other.fSum3;
+  fSum4 = other.fSum4;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
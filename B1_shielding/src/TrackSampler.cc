@@ -0,0 +1,227 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/TrackSampler.cc
+/// \brief Implementation of the B1::TrackSampler class
+
+#include "TrackSampler.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <sstream>
+
+namespace B1
+{
+
+std::atomic<std::uint64_t> TrackSampler::fBudgetBytes{100ull * 1024 * 1024};
+std::atomic<std::uint64_t> TrackSampler::fUsedBytes{0};
+std::atomic<std::uint64_t> TrackSampler::fEventsInRun{1};
+std::atomic<std::uint64_t> TrackSampler::fRowsWritten{0};
+std::atomic<std::uint64_t> TrackSampler::fEventsDropped{0};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackSampler::TrackSampler()
+{
+  fMessenger = new G4GenericMessenger(this, "/tracks/", "TrackData sampling control");
+  fMessenger->DeclareProperty("enable", fEnabled)
+            .SetGuidance("Enable/disable TrackData recording");
+  fMessenger->DeclareProperty("samplesPerEvent", fSamplesPerEvent)
+            .SetGuidance("Reservoir size: max number of sampled steps per event")
+            .SetRange("samplesPerEvent>=0");
+  fMessenger->DeclareMethod("particles", &TrackSampler::SetParticles)
+            .SetGuidance("Particles to record: 'all' or a list of names/PDG codes, e.g. \"neutron gamma\"");
+  fMessenger->DeclarePropertyWithUnit("minEnergy", "MeV", fMinEnergy)
+            .SetGuidance("Lower cut on the post-step kinetic energy of recorded steps");
+  fMessenger->DeclarePropertyWithUnit("maxEnergy", "MeV", fMaxEnergy)
+            .SetGuidance("Upper cut on the post-step kinetic energy of recorded steps");
+  fMessenger->DeclareMethod("maxMB", &TrackSampler::SetBudgetMB)
+            .SetGuidance("Hard per-run TrackData size budget in MB (all threads)")
+            .SetGuidance("Shared out per event over the /run/beamOn count: a run stopped early")
+            .SetGuidance("(/scoring/convergence/) uses only the matching fraction of the budget");
+  fMessenger->DeclareProperty("seed", fSeed)
+            .SetGuidance("Seed combined with the event ID for reproducible selection");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackSampler::~TrackSampler()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackSampler::SetParticles(const G4String& list)
+{
+  fParticles.clear();
+  std::istringstream iss(list);
+  G4String token;
+  while (iss >> token) {
+    if (token == "all") { fParticles.clear(); return; }
+    auto particle = G4ParticleTable::GetParticleTable()->FindParticle(token);
+    if (particle) {
+      fParticles.insert(particle->GetPDGEncoding());
+    }
+    else {
+      try { fParticles.insert(std::stoi(token)); }
+      catch (...) { G4cerr << "WARNING: /tracks/particles: unknown particle " << token << G4endl; }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackSampler::SetBudgetMB(G4double megabytes)
+{
+  fBudgetBytes = static_cast<std::uint64_t>(std::max(megabytes, 0.) * 1024. * 1024.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// splitmix64：状态只由 eventID 与种子决定
+std::uint64_t TrackSampler::NextRandom()
+{
+  std::uint64_t z = (fRngState += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackSampler::BeginOfEvent(G4int eventID)
+{
+  fEventID = eventID;
+  fCandidates = 0;
+  fRngState = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(fSeed)) << 32)
+              ^ static_cast<std::uint32_t>(eventID);
+  fReservoir.clear();
+
+  // 预算分摊：只依赖 eventID 与本run事件数
+  const std::uint64_t rows = fBudgetBytes.load() / kBytesPerRow;
+  const std::uint64_t nEvents = std::max<std::uint64_t>(fEventsInRun.load(), 1);
+  const std::uint64_t perEvent = rows / nEvents;
+  if (perEvent >= 1) {
+    fEventLimit = static_cast<G4int>(std::min<std::uint64_t>(perEvent, std::max(fSamplesPerEvent, 0)));
+  }
+  else {
+    const std::uint64_t stride = rows ? (nEvents + rows - 1) / rows : 0;
+    fEventLimit = (stride && static_cast<std::uint64_t>(eventID) % stride == 0) ? std::min(fSamplesPerEvent, 1) : 0;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackSampler::Offer(const G4Step* step)
+{
+  if (!fEnabled || fEventLimit <= 0) return;
+
+  const G4Track* track = step->GetTrack();
+  G4int pdg = track->GetDefinition()->GetPDGEncoding();
+  if (!fParticles.empty() && fParticles.count(pdg) == 0) return;
+  G4double energy = track->GetKineticEnergy();
+  if (energy < fMinEnergy || energy > fMaxEnergy) return;
+
+  // 蓄水池抽样（Algorithm R）：前k个直接保留，之后以 k/n 概率替换
+  std::size_t slot;
+  if (fCandidates < static_cast<std::uint64_t>(fEventLimit)) {
+    slot = fReservoir.size();
+    fReservoir.emplace_back();
+  }
+  else {
+    std::uint64_t j = NextRandom() % (fCandidates + 1);
+    if (j >= static_cast<std::uint64_t>(fEventLimit)) { ++fCandidates; return; }
+    slot = static_cast<std::size_t>(j);
+  }
+  ++fCandidates;
+
+  G4ThreeVector position = step->GetPreStepPoint()->GetPosition();
+  Record& rec = fReservoir[slot];
+  rec.trackID = track->GetTrackID();
+  rec.parentID = track->GetParentID();
+  rec.pdgCode = pdg;
+  rec.x = position.x()/cm;  // 位置转换为cm
+  rec.y = position.y()/cm;
+  rec.z = position.z()/cm;
+  rec.kineticEnergy = energy/MeV;
+  rec.time = track->GetGlobalTime()/ns;
+  rec.stepNumber = track->GetCurrentStepNumber();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const std::vector<TrackSampler::Record>& TrackSampler::EndOfEvent()
+{
+  if (fReservoir.empty()) return fReservoir;
+
+  // 整个事件一次性申请预算（分摊后不会超出；事件数多于 beamOn 给出的N时作为硬上限）
+  const std::uint64_t need = fReservoir.size() * kBytesPerRow;
+  const std::uint64_t budget = fBudgetBytes.load();
+  std::uint64_t used = fUsedBytes.load();
+  do {
+    if (used + need > budget) {
+      ++fEventsDropped;
+      return fEmpty;
+    }
+  } while (!fUsedBytes.compare_exchange_weak(used, used + need));
+
+  fRowsWritten += fReservoir.size();
+  return fReservoir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackSampler::ResetBudget(G4int nEvents)
+{
+  fEventsInRun = static_cast<std::uint64_t>(std::max(nEvents, 1));
+  fUsedBytes = 0;
+  fRowsWritten = 0;
+  fEventsDropped = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackSampler::PrintSummary()
+{
+  G4cout << "TrackData sampling: " << fRowsWritten.load() << " rows ("
+         << fUsedBytes.load() / (1024. * 1024.) << " of "
+         << fBudgetBytes.load() / (1024. * 1024.) << " MB budget)";
+  if (fEventsDropped.load() > 0) {
+    G4cout << ", " << fEventsDropped.load() << " events skipped at the hard budget limit";
+  }
+  G4cout << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
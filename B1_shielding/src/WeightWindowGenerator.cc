@@ -0,0 +1,164 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/WeightWindowGenerator.cc
+/// \brief Implementation of the B1::WeightWindowGenerator class
+
+#include "WeightWindowGenerator.hh"
+
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WeightWindowGenerator::WeightWindowGenerator(const G4String& outputFile, const G4String& particle,
+                                             G4int nLayers, const std::vector<G4double>& upperEnergies)
+  : G4VAccumulable("WeightWindowFlux"), fOutputFile(outputFile)
+{
+  fMesh.particle = particle;
+  fMesh.nLayers = nLayers;
+  fMesh.upperEnergies = upperEnergies;
+  fFlux.assign(static_cast<std::size_t>(nLayers) * upperEnergies.size(), 0.);
+
+  // 粒子表在物理列表构建之前可能为空，此时按名称回退到常用PDG码
+  if (auto def = G4ParticleTable::GetParticleTable()->FindParticle(particle)) {
+    fPDGCode = def->GetPDGEncoding();
+  }
+  else {
+    fPDGCode = (particle == "gamma") ? 22 : 2112;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WeightWindowGenerator::SetExtent(G4double zMin, G4double zMax)
+{
+  fMesh.zMin = zMin;
+  fMesh.zMax = zMax;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WeightWindowGenerator::Score(G4int pdgCode, G4double z, G4double energy, G4double weightedLength)
+{
+  if (pdgCode != fPDGCode) return;
+  G4int cell = fMesh.CellIndex(z);
+  if (cell < 1 || cell > fMesh.nLayers) return;
+  fFlux[static_cast<std::size_t>(cell - 1) * fMesh.NumberOfGroups() + fMesh.GroupIndex(energy)]
+    += weightedLength;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WeightWindowGenerator::Merge(const G4VAccumulable& other)
+{
+  const auto& rhs = static_cast<const WeightWindowGenerator&>(other);
+  for (std::size_t i = 0; i < fFlux.size() && i < rhs.fFlux.size(); ++i) {
+    fFlux[i] += rhs.fFlux[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WeightWindowGenerator::Reset()
+{
+  std::fill(fFlux.begin(), fFlux.end(), 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WeightWindowGenerator::WriteWindows() const
+{
+  const G4double survivalFactor = WeightWindowMesh::kSurvivalFactor;
+  const G4int nGroups = fMesh.NumberOfGroups();
+  const G4int nLayers = fMesh.nLayers;
+  if (nGroups <= 0 || fFlux.size() < static_cast<std::size_t>(nGroups)) {
+    G4cerr << "WARNING: weight-window mesh has no energy groups; " << fOutputFile << " not written" << G4endl;
+    return;
+  }
+  const G4double phiRef = *std::max_element(fFlux.begin(), fFlux.begin() + nGroups);
+  if (phiRef <= 0.) {
+    G4cerr << "WARNING: weight-window pilot run scored no flux in the first layer; "
+           << fOutputFile << " not written" << G4endl;
+    return;
+  }
+
+  WeightWindowMesh mesh = fMesh;
+  mesh.lowerWeights.assign(static_cast<std::size_t>(mesh.NumberOfCells()) * nGroups, 0.);
+  std::vector<G4double> previous(nGroups, 1. / survivalFactor);
+  for (G4int layer = 0; layer < nLayers; ++layer) {
+    const G4double* phi = &fFlux[static_cast<std::size_t>(layer) * nGroups];
+    // 无通量的能群取本层最小非零值（再无则沿用上一层），避免零下限
+    G4double minNonZero = 0.;
+    for (G4int g = 0; g < nGroups; ++g) {
+      if (phi[g] > 0. && (minNonZero == 0. || phi[g] < minNonZero)) minNonZero = phi[g];
+    }
+    for (G4int g = 0; g < nGroups; ++g) {
+      G4double value = (phi[g] > 0.) ? phi[g] : minNonZero;
+      G4double lower = (value > 0.) ? value / phiRef / survivalFactor : previous[g];
+      mesh.lowerWeights[static_cast<std::size_t>(layer + 1) * nGroups + g] = lower;
+      previous[g] = lower;
+    }
+  }
+  // 上游同第一层，下游同最后一层
+  for (G4int g = 0; g < nGroups; ++g) {
+    mesh.lowerWeights[g] = mesh.lowerWeights[static_cast<std::size_t>(nGroups) + g];
+    mesh.lowerWeights[static_cast<std::size_t>(nLayers + 1) * nGroups + g]
+      = mesh.lowerWeights[static_cast<std::size_t>(nLayers) * nGroups + g];
+  }
+
+  if (mesh.Save(fOutputFile)) {
+    G4cout << "Weight windows written to " << fOutputFile << " ("
+           << nLayers << " layers x " << nGroups << " groups)" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WeightWindowGenerator* WeightWindowGenerator::CreateFromEnvironment()
+{
+  const char* envFile = std::getenv("NGAMMA_WW_GENERATE");
+  if (!envFile || envFile[0] == '\0') return nullptr;
+
+  const char* envLayers = std::getenv("NGAMMA_WW_LAYERS");
+  G4int nLayers = envLayers ? std::atoi(envLayers) : 10;
+  if (nLayers <= 0) nLayers = 10;
+  const char* envParticle = std::getenv("NGAMMA_WW_PARTICLE");
+  G4String particle = (envParticle && envParticle[0] != '\0') ? envParticle : "neutron";
+
+  return new WeightWindowGenerator(envFile, particle, nLayers,
+                                   WeightWindowMesh::EnergyBoundsFromEnvironment());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
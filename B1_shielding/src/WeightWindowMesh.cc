@@ -0,0 +1,202 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/WeightWindowMesh.cc
+/// \brief Implementation of the B1::WeightWindowMesh class
+
+#include "WeightWindowMesh.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int WeightWindowMesh::CellIndex(G4double z) const
+{
+  if (z < zMin) return 0;
+  if (z >= zMax) return nLayers + 1;
+  G4int layer = static_cast<G4int>((z - zMin) / (zMax - zMin) * nLayers);
+  return 1 + std::min(layer, nLayers - 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int WeightWindowMesh::GroupIndex(G4double energy) const
+{
+  auto it = std::lower_bound(upperEnergies.begin(), upperEnergies.end(), energy);
+  if (it == upperEnergies.end()) return NumberOfGroups() - 1;
+  return static_cast<G4int>(it - upperEnergies.begin());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4double> WeightWindowMesh::CellLowerWeights(G4int cell) const
+{
+  auto first = lowerWeights.begin() + static_cast<std::ptrdiff_t>(cell) * NumberOfGroups();
+  return std::vector<G4double>(first, first + NumberOfGroups());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool WeightWindowMesh::Load(const G4String& path)
+{
+  std::ifstream fin(path);
+  if (!fin.good()) {
+    G4cerr << "ERROR: cannot open weight-window file " << path << G4endl;
+    return false;
+  }
+
+  lowerWeights.clear();
+  upperEnergies.clear();
+  std::string line;
+  while (std::getline(fin, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream iss(line);
+    std::string key;
+    iss >> key;
+    if (key == "particle") {
+      iss >> particle;
+    }
+    else if (key == "layers") {
+      iss >> nLayers >> zMin >> zMax;
+      zMin *= mm;
+      zMax *= mm;
+    }
+    else if (key == "ebounds") {
+      G4int nGroups = 0;
+      iss >> nGroups;
+      for (G4int g = 0; g < nGroups; ++g) {
+        G4double e = 0.;
+        iss >> e;
+        upperEnergies.push_back(e * MeV);
+      }
+    }
+    else if (key == "cell") {
+      // 窗数组在第一条 cell 行按此时的层数与能群数分配：layers 与 ebounds 须先给出，
+      // 否则（手工编辑的文件）按 0 层分配会越界写
+      if (nLayers <= 0 || upperEnergies.empty()) {
+        G4cerr << "ERROR: 'cell' before 'layers' and 'ebounds' in weight-window file " << path << G4endl;
+        return false;
+      }
+      if (lowerWeights.empty()) {
+        lowerWeights.assign(static_cast<std::size_t>(NumberOfCells()) * NumberOfGroups(), 0.);
+      }
+      G4int cell = -1;
+      iss >> cell;
+      const std::size_t first = static_cast<std::size_t>(cell) * NumberOfGroups();
+      if (cell < 0 || first + NumberOfGroups() > lowerWeights.size()) {
+        G4cerr << "ERROR: cell " << cell << " out of range in weight-window file " << path << G4endl;
+        return false;
+      }
+      for (G4int g = 0; g < NumberOfGroups(); ++g) {
+        iss >> lowerWeights[first + g];
+      }
+    }
+  }
+
+  // layers/ebounds 在 cell 行之后又被改写时数组大小不再一致
+  G4bool ok = nLayers > 0 && zMax > zMin && !upperEnergies.empty()
+              && lowerWeights.size() == static_cast<std::size_t>(NumberOfCells()) * NumberOfGroups()
+              && std::none_of(lowerWeights.begin(), lowerWeights.end(),
+                              [](G4double w) { return w <= 0.; });
+  if (!ok) {
+    G4cerr << "ERROR: incomplete or invalid weight-window file " << path << G4endl;
+    return false;
+  }
+  // 最后一群上界放宽，避免超出网格的粒子找不到窗
+  upperEnergies.back() = std::max(upperEnergies.back(), 1.*TeV);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool WeightWindowMesh::Save(const G4String& path) const
+{
+  std::ofstream fout(path);
+  if (!fout.good()) {
+    G4cerr << "ERROR: cannot write weight-window file " << path << G4endl;
+    return false;
+  }
+  fout << "# ngamma weight windows (lower weight bounds; cell 0 = upstream, "
+       << nLayers + 1 << " = downstream)\n";
+  fout << "particle " << particle << "\n";
+  fout << "layers " << nLayers << " " << zMin/mm << " " << zMax/mm << "\n";
+  fout << "ebounds " << NumberOfGroups();
+  for (G4double e : upperEnergies) fout << " " << e/MeV;
+  fout << "\n" << std::scientific << std::setprecision(6);
+  for (G4int cell = 0; cell < NumberOfCells(); ++cell) {
+    fout << "cell " << cell;
+    for (G4double w : CellLowerWeights(cell)) fout << " " << w;
+    fout << "\n";
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  const char* kDefaultEnergyBounds = "1e-7,1e-5,1e-3,0.1,0.5,1,2,5,20";
+
+  // 逗号/空白分隔的能量（MeV）→ 升序去重的正值；遇到非数字即停止
+  std::vector<G4double> ParseEnergyBounds(std::string list)
+  {
+    for (auto& c : list) { if (c == ',') c = ' '; }
+    std::istringstream iss(list);
+    std::vector<G4double> bounds;
+    G4double e;
+    while (iss >> e) {
+      if (e > 0.) bounds.push_back(e * MeV);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    return bounds;
+  }
+}
+
+std::vector<G4double> WeightWindowMesh::EnergyBoundsFromEnvironment()
+{
+  const char* env = std::getenv("NGAMMA_WW_EBOUNDS");
+  if (env && env[0] != '\0') {
+    std::vector<G4double> bounds = ParseEnergyBounds(env);
+    if (!bounds.empty()) return bounds;
+    // 没有可用能群时网格为0群，权窗生成与读入都无意义
+    G4cerr << "WARNING: NGAMMA_WW_EBOUNDS=\"" << env << "\" has no positive energies; using the default "
+           << kDefaultEnergyBounds << " MeV" << G4endl;
+  }
+  return ParseEnergyBounds(kDefaultEnergyBounds);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B1
@@ -0,0 +1,14 @@
+#!/usr/bin/env python3
+"""
+数据目录：exampleB1（RunAction）写出run目录的位置，job_scheduler.py、result_cache.py
+与 run_catalog.py 共用同一规则：环境变量 NGAMMA_DATA_DIR 优先，缺省 ~/ngamma/data。
+相对路径按当前工作目录展开为绝对路径（与 RunAction 相同）。
+"""
+import os
+
+DEFAULT_DATA_DIR = os.path.join('~', 'ngamma', 'data')
+
+
+def data_dir():
+    env = os.environ.get('NGAMMA_DATA_DIR', '')
+    return os.path.abspath(os.path.expanduser(env if env else DEFAULT_DATA_DIR))
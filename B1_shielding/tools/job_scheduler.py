@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""
+本地并行作业调度：同时运行多个 exampleB1 进程（sweep_recipes.py 的 "parallel" 配置使用）。
+
+- 并发：至多 jobs 个进程，每个进程 threads_per_job 个线程（NGAMMA_THREADS）
+- CPU绑定：pin_cpus=true 时把可用CPU按 threads_per_job 分组，每个运行中的作业独占一组
+  （os.sched_setaffinity，仅Linux），避免多个进程的线程互相迁移、抢同一物理核
+- 内存准入：启动新作业前要求 /proc/meminfo 的 MemAvailable ≥ 单作业估计 + 保留量；
+  单作业估计取配置值与已运行作业峰值RSS（VmHWM）×1.1 的较大者（HP数据使每个进程很大）
+- 随机数：每次尝试写一个包装宏 "/random/setSeeds s1 s2" + "/control/execute <宏>"，
+  种子由 base_seed、作业名与尝试次数哈希得到：可复现，且不同作业/重试互不相同
+- 成败：宏模式下命令出错时 exampleB1 仍以0退出，所以只有返回码为0、日志中有
+  run_metadata.json 写出的 "[metadata] config_hash" 行、宏未被中断
+  （"Batch is interrupted"）、没有配方加载错误（GlassRecipe001）且没有非0的
+  "[QUEUE] done ... status=" 行的作业才算完成
+- 重试：失败的作业以新种子重新排队，至多 max_retries 次（配方加载错误不重试）
+- 进度：每次状态变化打印一行 [SCHED] 完成/运行/失败计数与预计剩余时间；
+  每个作业的标准输出写入 log_dir/<作业名>.a<尝试>.log（缺省为数据目录下的 sched_logs/，
+  与 RunAction 相同：NGAMMA_DATA_DIR 优先，见 data_paths.py）
+
+单独使用：
+  job_scheduler.py [--jobs N] [--threads T] [--mem-mb M] [--retries R] [--seed S] [--no-pin] a.mac b.mac ...
+"""
+import os
+import re
+import sys
+import time
+import signal
+import hashlib
+import subprocess
+from collections import deque
+from datetime import datetime
+
+from data_paths import data_dir
+
+ROOT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BUILD_EXE = os.path.join(ROOT_DIR, 'build', 'exampleB1')
+# run完整结束（RunConfiguration::WriteMetadata）与宏中命令出错（G4UIbatch）时的输出
+METADATA_MARK = "[metadata] config_hash ="
+BATCH_ABORT_MARK = "Batch is interrupted"
+# 配方文件缺失/无法解析/含未知组分（DetectorConstruction::SetGlassCompositionFile）
+RECIPE_ERROR_MARK = "GlassRecipe001"
+QUEUE_STATUS_RE = re.compile(r"^\[QUEUE\] done .* status=(-?\d+)", re.M)
+
+
+def default_log_dir():
+    # 日志放在数据目录下，不写进源码树
+    return os.path.join(data_dir(), 'sched_logs')
+
+
+def mem_available_mb():
+    try:
+        with open('/proc/meminfo') as f:
+            for line in f:
+                if line.startswith('MemAvailable:'):
+                    return int(line.split()[1]) / 1024.0
+    except OSError:
+        pass
+    return None
+
+
+def peak_rss_mb(pid):
+    try:
+        with open(f'/proc/{pid}/status') as f:
+            for line in f:
+                if line.startswith('VmHWM:'):
+                    return int(line.split()[1]) / 1024.0
+    except OSError:
+        pass
+    return 0.0
+
+
+def job_seeds(base_seed, name, attempt):
+    """两个正的31位种子（Geant4 /random/setSeeds 接受 long）"""
+    h = hashlib.sha256(f"{base_seed}:{name}:{attempt}".encode()).digest()
+    s1 = int.from_bytes(h[0:4], 'little') & 0x7fffffff
+    s2 = int.from_bytes(h[4:8], 'little') & 0x7fffffff
+    return max(s1, 1), max(s2, 1)
+
+
+def _fmt_duration(seconds):
+    seconds = int(max(seconds, 0))
+    return f"{seconds // 3600:d}h{seconds % 3600 // 60:02d}m{seconds % 60:02d}s"
+
+
+class Job:
+    def __init__(self, name, macro, env=None, seed_key=None):
+        self.name = name
+        self.macro = macro
+        self.env = env or {}
+        self.seed_key = seed_key or name
+        self.attempt = 0
+        self.proc = None
+        self.cpus = None
+        self.log = None
+        self.start = None
+        self.returncode = None
+
+
+class JobScheduler:
+    def __init__(self, jobs=None, threads_per_job=1, mem_per_job_mb=2000, mem_reserve_mb=1000,
+                 max_retries=1, pin_cpus=True, base_seed=12345, log_dir=None, exe=BUILD_EXE,
+                 poll_interval=1.0):
+        self.threads = max(int(threads_per_job), 1)
+        self.exe = exe
+        self.mem_per_job_mb = float(mem_per_job_mb)
+        self.mem_reserve_mb = float(mem_reserve_mb)
+        self.max_retries = int(max_retries)
+        self.base_seed = base_seed
+        self.log_dir = log_dir or default_log_dir()
+        self.poll_interval = poll_interval
+
+        cpus = sorted(os.sched_getaffinity(0)) if hasattr(os, 'sched_getaffinity') else list(range(os.cpu_count() or 1))
+        self.pin = bool(pin_cpus) and hasattr(os, 'sched_setaffinity') and len(cpus) >= self.threads
+        max_by_cpu = max(len(cpus) // self.threads, 1)
+        self.max_jobs = min(int(jobs), max_by_cpu) if jobs else max_by_cpu
+        # CPU组：每个运行中的作业占用一组
+        self.free_cpu_sets = deque(tuple(cpus[i * self.threads:(i + 1) * self.threads])
+                                   for i in range(max_by_cpu))
+
+        self.pending = deque()
+        self.running = []
+        self.done = []
+        self.failed = []
+        self.total = 0
+        self.observed_peak_mb = 0.0
+        self.t0 = None
+
+    def submit(self, name, macro, env=None, seed_key=None):
+        # seed_key：种子来源（缺省为作业名）；结果缓存按作业键与续算序号给出，使种子与网格编号无关
+        self.pending.append(Job(name, macro, env, seed_key))
+        self.total += 1
+
+    # -- 准入与启动 -------------------------------------------------------
+
+    def _mem_estimate_mb(self):
+        return max(self.mem_per_job_mb, 1.1 * self.observed_peak_mb)
+
+    def _can_admit(self):
+        if not self.pending or len(self.running) >= self.max_jobs:
+            return False
+        if self.pin and not self.free_cpu_sets:
+            return False
+        avail = mem_available_mb()
+        if avail is None:
+            return True
+        # 刚启动的作业尚未占满内存：按估计值扣除其余量
+        committed = sum(max(self._mem_estimate_mb() - peak_rss_mb(j.proc.pid), 0.0) for j in self.running)
+        ok = avail - committed >= self._mem_estimate_mb() + self.mem_reserve_mb
+        if not ok and not self.running:
+            # 单个作业也放不下时仍运行一个，避免死等
+            print(f"[SCHED] low memory ({avail:.0f} MB available), running one job at a time")
+            return True
+        return ok
+
+    def _start(self, job):
+        job.attempt += 1
+        os.makedirs(self.log_dir, exist_ok=True)
+        s1, s2 = job_seeds(self.base_seed, job.seed_key, job.attempt)
+        wrapper = os.path.join(self.log_dir, f"{job.name}.a{job.attempt}.mac")
+        with open(wrapper, 'w') as f:
+            f.write(f"/random/setSeeds {s1} {s2}\n")
+            f.write(f"/control/execute {job.macro}\n")
+
+        env = os.environ.copy()
+        env.update(job.env)
+        env['NGAMMA_THREADS'] = str(self.threads)
+        job.cpus = self.free_cpu_sets.popleft() if self.pin else None
+        cpus = job.cpus
+
+        def pin_child():
+            if cpus:
+                os.sched_setaffinity(0, cpus)
+
+        job.log = open(os.path.join(self.log_dir, f"{job.name}.a{job.attempt}.log"), 'w')
+        job.start = time.time()
+        job.proc = subprocess.Popen([self.exe, wrapper], cwd=ROOT_DIR, env=env,
+                                    stdout=job.log, stderr=subprocess.STDOUT,
+                                    preexec_fn=pin_child if cpus else None)
+        self.running.append(job)
+        where = f" cpus={cpus[0]}-{cpus[-1]}" if cpus else ""
+        print(f"[SCHED] start {job.name} (attempt {job.attempt}, seeds {s1} {s2}{where})")
+
+    def _finish(self, job):
+        job.returncode = job.proc.returncode
+        job.log.close()
+        self.running.remove(job)
+        if job.cpus:
+            self.free_cpu_sets.append(job.cpus)
+        elapsed = time.time() - job.start
+        if job.returncode == 0:
+            job.returncode = self._log_failure(job) or 0
+        if job.returncode == 0:
+            self.done.append((job, elapsed))
+            print(f"[SCHED] done  {job.name} in {_fmt_duration(elapsed)}")
+        # 配方错误与种子无关，重试不会成功
+        elif job.attempt <= self.max_retries and job.returncode != 'recipe load error':
+            print(f"[SCHED] retry {job.name}: status {job.returncode}, see {job.log.name}")
+            self.pending.append(job)
+        else:
+            self.failed.append(job)
+            print(f"[SCHED] FAIL  {job.name}: status {job.returncode} after {job.attempt} attempts")
+        self._progress()
+
+    @staticmethod
+    def _log_failure(job):
+        """返回码为0时按日志判断成败：成功返回None，否则返回失败原因"""
+        try:
+            with open(job.log.name, errors='replace') as f:
+                text = f.read()
+        except OSError:
+            return 'no log'
+        if RECIPE_ERROR_MARK in text:
+            return 'recipe load error'
+        if BATCH_ABORT_MARK in text:
+            return 'macro interrupted'
+        if any(int(code) != 0 for code in QUEUE_STATUS_RE.findall(text)):
+            return 'queue job failed'
+        if METADATA_MARK not in text:
+            return 'no run_metadata'
+        return None
+
+    def _progress(self):
+        finished = len(self.done) + len(self.failed)
+        line = f"[SCHED] {finished}/{self.total} finished, {len(self.running)} running"
+        if self.failed:
+            line += f", {len(self.failed)} failed"
+        if self.done:
+            # 按已完成作业的平均墙钟时间与并发数估计剩余时间
+            avg = sum(e for _, e in self.done) / len(self.done)
+            remaining = self.total - finished
+            line += f", ETA {_fmt_duration(avg * remaining / self.max_jobs)}"
+        line += f", elapsed {_fmt_duration(time.time() - self.t0)}"
+        print(line, flush=True)
+
+    # -- 主循环 -----------------------------------------------------------
+
+    def run(self):
+        """运行全部作业；返回失败作业名列表"""
+        self.t0 = time.time()
+        print(f"[SCHED] {self.total} jobs, up to {self.max_jobs} concurrent x {self.threads} threads"
+              f"{', CPU pinning' if self.pin else ''}, ~{self.mem_per_job_mb:.0f} MB/job")
+        try:
+            while self.pending or self.running:
+                while self._can_admit():
+                    self._start(self.pending.popleft())
+                time.sleep(self.poll_interval)
+                for job in list(self.running):
+                    self.observed_peak_mb = max(self.observed_peak_mb, peak_rss_mb(job.proc.pid))
+                    if job.proc.poll() is not None:
+                        self._finish(job)
+        except KeyboardInterrupt:
+            print("[SCHED] interrupted, terminating running jobs")
+            for job in self.running:
+                job.proc.send_signal(signal.SIGTERM)
+            for job in self.running:
+                job.proc.wait()
+            raise
+        print(f"[SCHED] all done: {len(self.done)} ok, {len(self.failed)} failed, "
+              f"wall {_fmt_duration(time.time() - self.t0)}, peak RSS/job {self.observed_peak_mb:.0f} MB")
+        return [job.name for job in self.failed]
+
+
+def main():
+    import argparse
+    ap = argparse.ArgumentParser(description="Run exampleB1 macros concurrently")
+    ap.add_argument('macros', nargs='+')
+    ap.add_argument('--jobs', type=int, default=None, help="max concurrent jobs (default: CPUs / threads)")
+    ap.add_argument('--threads', type=int, default=1, help="threads per job (NGAMMA_THREADS)")
+    ap.add_argument('--mem-mb', type=float, default=2000, help="initial memory estimate per job")
+    ap.add_argument('--retries', type=int, default=1)
+    ap.add_argument('--seed', type=int, default=12345)
+    ap.add_argument('--no-pin', action='store_true')
+    args = ap.parse_args()
+
+    sched = JobScheduler(jobs=args.jobs, threads_per_job=args.threads, mem_per_job_mb=args.mem_mb,
+                         max_retries=args.retries, pin_cpus=not args.no_pin, base_seed=args.seed)
+    stamp = datetime.now().strftime('%Y%m%d_%H%M%S')
+    for i, macro in enumerate(args.macros, 1):
+        name = f"{stamp}_{i:04d}_{os.path.splitext(os.path.basename(macro))[0]}"
+        sched.submit(name, os.path.abspath(macro))
+    failed = sched.run()
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
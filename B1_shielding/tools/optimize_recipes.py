@@ -0,0 +1,428 @@
+#!/usr/bin/env python3
+"""
+代理模型驱动的自适应配方优化（sweep_recipes.py 的穷举网格之外的另一种驱动）：
+
+  1) 初始设计：在有界单纯形上做LHS（recipe_space.py），每个配方对每个源各跑一次
+  2) 读取已完成run的实际输出（结果目录中的 tally_statistics.txt：每个源粒子的
+     gamma/neutron 透射、capture、dpa、edep、niel 均值与相对误差；composition.txt 的密度）
+  3) ParEGO：每个新点抽一组随机权重，把各目标（"log": true 的先取log10，再按已观测范围归一化）
+     用增广Tchebycheff函数合成一个标量，拟合高斯过程（RBF核，长度尺度按边际似然选取，
+     噪声项由run的相对误差给出），在候选配方（Halton采样）上取期望改进EI最大者
+  4) 一批 batch_size 个新配方本地运行（parallel 配置同 sweep_recipes.py，走 job_scheduler），
+     重复 iterations 轮；每轮写出历史与当前Pareto前沿
+
+运行经 result_cache.py：已有足够事件的同一作业直接复用，中断后重跑同一配置只会补算缺的点。
+resume=true 时还读入已有的历史文件作为观测数据。
+
+JSON 配置（示例见 optimize_recipes.example.json）：
+{
+  "components": [{"name": "sio2", "min": 35, "max": 60}, ...],     # 只用 min/max
+  "sources": [{"name": "gamma662keV", "macro": "macros/gamma_shielding.mac"},
+              {"name": "cf252", "macro": "macros/Cf252_neutron_test.mac"}],
+  "objectives": [{"source": "gamma662keV", "tally": "gamma", "sense": "min", "log": true},
+                 {"source": "cf252", "tally": "neutron", "sense": "min", "log": true},
+                 {"source": "cf252", "tally": "dpa", "sense": "min"}],
+  "events_per_run": 200000,
+  "initial_points": 12, "batch_size": 4, "iterations": 8,
+  "candidates": 2000, "decimals": 1, "seed": 1,
+  "history": "macros/recipes/optimize_history.csv", "resume": true,
+  "parallel": {"jobs": 4, "threads_per_job": 2}
+}
+tally 取 tally_statistics.txt 中的名称（gamma、neutron、capture、dpa、edep、niel）或 density。
+目标缺省按原值（线性）参与拟合；"log": true 时取log10，均值低于下限 floor 时按 floor 计
+（为0时误差取 R = 1）。gamma、neutron、capture 这类每历史计数的 floor 缺省 0.5/N（N 为该run
+的事件数）；edep、dpa、niel、density 取 log 时必须给出 floor（低于预期最小值），否则拒绝配置，
+避免零或极小的值变成 -inf 或主导高斯过程拟合。
+
+用法：optimize_recipes.py <config.json> [--dry-run]
+"""
+import os
+import sys
+import math
+import random
+import hashlib
+import json
+
+import result_cache
+import recipe_space
+from job_scheduler import job_seeds
+from sweep_recipes import (BUILD_EXE, RECIPES_DIR, rebuild, load_config, write_recipe,
+                           build_macro_for_source, _prepend_lines, _job_env, run_parallel, run_sim)
+
+ROOT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+# 每历史计数：log 目标的缺省下限 0.5/N 有意义；其余量取 log 时必须给出 floor
+COUNT_TALLIES = ('gamma', 'neutron', 'capture')
+
+
+# -- 运行与读取结果 -------------------------------------------------------------
+
+def recipe_tag(recipe):
+    text = ";".join(f"{k}:{v:g}" for k, v in sorted(recipe.items()))
+    return "opt_" + hashlib.sha1(text.encode()).hexdigest()[:10]
+
+
+def read_run(run_dir):
+    """结果目录 → {tally: (均值, 相对误差)}；含 density 与 events（无误差）"""
+    out = {}
+    path = os.path.join(run_dir, 'tally_statistics.txt')
+    if os.path.isfile(path):
+        for line in open(path):
+            if line.startswith('#') or not line.strip():
+                continue
+            name, mean, rel = line.split()[:3]
+            out[name] = (float(mean), float(rel))
+    meta = os.path.join(run_dir, 'run_metadata.json')
+    if os.path.isfile(meta):
+        with open(meta) as f:
+            out['events'] = (float(json.load(f).get('events', 0)), 0.0)
+    comp = os.path.join(run_dir, 'composition.txt')
+    if os.path.isfile(comp):
+        for line in open(comp):
+            if line.startswith('Density:'):
+                out['density'] = (float(line.split()[1]), 0.0)
+    return out
+
+
+def evaluate_batch(recipes, cfg, dry_run=False):
+    """运行（或从缓存取）每个配方 × 每个源；返回 [{源名: read_run(...)}]"""
+    events = int(cfg.get('events_per_run', 100000))
+    par_cfg = cfg.get('parallel') or {}
+    parallel = bool(par_cfg) and int(par_cfg.get('jobs') or 0) != 1
+    base_seed = par_cfg.get('base_seed', 12345)
+    lookups = []
+    jobs = []
+    merge_keys = []
+    for i, recipe in enumerate(recipes):
+        tag = recipe_tag(recipe)
+        recipe_path = write_recipe(recipe, tag)
+        for src in cfg.get('sources', []):
+            name = src.get('name', 'src')
+            macro = src['macro']
+            macro_abs = macro if os.path.isabs(macro) else os.path.join(ROOT_DIR, macro)
+            auto_macro = build_macro_for_source(macro_abs, recipe_path, events)
+            env = dict(os.environ)
+            env.update(_job_env(macro_abs))
+            key = result_cache.job_key(auto_macro, env)
+            lookups.append((i, name, key))
+            state, data = result_cache.lookup(key, events)
+            if state == 'hit':
+                os.remove(auto_macro)
+                continue
+            if state == 'extend':
+                # 已有run事件数不足（提前结束或中止）：只补差额，之后合并
+                runs, more = data
+                merge_keys.append(key)
+                os.remove(auto_macro)
+                if more <= 0:
+                    continue
+                auto_macro = build_macro_for_source(macro_abs, recipe_path, more)
+            seed_key = f"{key}:{result_cache.seed_offset(key)}"
+            header = [f"/metadata/jobKey {key}"]
+            if not parallel:
+                s1, s2 = job_seeds(base_seed, seed_key, 1)
+                header.append(f"/random/setSeeds {s1} {s2}")
+            _prepend_lines(auto_macro, header)
+            if parallel:
+                jobs.append((f"{tag}_{name}", auto_macro, macro_abs, seed_key))
+            else:
+                rc = run_sim(auto_macro, macro_abs, dry_run)
+                if rc != 0:
+                    print(f"[WARN] {tag} {name}: exampleB1 returned {rc}")
+    if parallel and jobs:
+        failed = run_parallel(jobs, par_cfg, dry_run)
+        if failed:
+            print(f"[WARN] {len(failed)} jobs failed: {' '.join(failed)}")
+    if not dry_run:
+        for key in merge_keys:
+            try:
+                result_cache.merge_for_key(key)
+            except Exception as e:
+                print(f"[WARN] merge for {key} failed: {e}")
+
+    results = [dict() for _ in recipes]
+    for i, name, key in lookups:
+        state, run_dir = result_cache.lookup(key, events)
+        if state == 'hit':
+            results[i][name] = read_run(run_dir)
+    return results
+
+
+def objective_values(result, objectives):
+    """(目标值列表, 相对误差列表)；缺数据时返回 None。目标统一为越小越好"""
+    values, errors = [], []
+    for obj in objectives:
+        entry = result.get(obj['source'], {}).get(obj['tally'])
+        if entry is None:
+            return None
+        mean, rel = entry
+        if obj.get('log', False):
+            # 零计数是最好的结果而不是缺数据：取下限（计数缺省半个计数/N），为0时误差按 R = 1
+            n = result.get(obj['source'], {}).get('events', (0.0, 0.0))[0]
+            floor = obj.get('floor', 0.5 / n if n > 0 else 0.0)
+            if floor <= 0:
+                return None
+            if mean < floor:
+                mean, rel = floor, (rel if mean > 0 else 1.0)
+            v = math.log10(mean)
+            err = rel / math.log(10)  # d(log10 x) = R / ln10
+        else:
+            v = mean
+            err = abs(mean) * rel
+        sign = -1.0 if obj.get('sense', 'min') == 'max' else 1.0
+        values.append(sign * v)
+        errors.append(err)
+    return values, errors
+
+
+def pareto_mask(points):
+    """越小越好的非支配标记"""
+    mask = []
+    for i, p in enumerate(points):
+        dominated = any(all(q[k] <= p[k] for k in range(len(p))) and any(q[k] < p[k] for k in range(len(p)))
+                        for j, q in enumerate(points) if j != i)
+        mask.append(not dominated)
+    return mask
+
+
+# -- 高斯过程 -------------------------------------------------------------------
+
+def _cholesky(A):
+    n = len(A)
+    L = [[0.0] * n for _ in range(n)]
+    for i in range(n):
+        for j in range(i + 1):
+            s = A[i][j] - sum(L[i][k] * L[j][k] for k in range(j))
+            if i == j:
+                if s <= 0.0:
+                    return None
+                L[i][i] = math.sqrt(s)
+            else:
+                L[i][j] = s / L[j][j]
+    return L
+
+
+def _solve_lower(L, b):
+    x = []
+    for i in range(len(b)):
+        x.append((b[i] - sum(L[i][k] * x[k] for k in range(i))) / L[i][i])
+    return x
+
+
+def _solve_upper_t(L, b):
+    # 解 L^T x = b
+    n = len(b)
+    x = [0.0] * n
+    for i in range(n - 1, -1, -1):
+        x[i] = (b[i] - sum(L[k][i] * x[k] for k in range(i + 1, n))) / L[i][i]
+    return x
+
+
+class GaussianProcess:
+    """零均值（目标先标准化）RBF核高斯过程；长度尺度在网格上按对数边际似然选取"""
+
+    LENGTH_SCALES = (0.1, 0.2, 0.35, 0.6, 1.0, 2.0)
+
+    def fit(self, X, y, noise):
+        self.X = X
+        self.mean = sum(y) / len(y)
+        var = sum((v - self.mean) ** 2 for v in y) / max(len(y) - 1, 1)
+        self.std = math.sqrt(var) if var > 0 else 1.0
+        z = [(v - self.mean) / self.std for v in y]
+        nz = [max((e / self.std) ** 2, 1e-6) for e in noise]
+        best = None
+        for ell in self.LENGTH_SCALES:
+            K = [[self._k(a, b, ell) + (nz[i] if i == j else 0.0) for j, b in enumerate(X)]
+                 for i, a in enumerate(X)]
+            L = _cholesky(K)
+            if L is None:
+                continue
+            alpha = _solve_upper_t(L, _solve_lower(L, z))
+            lml = (-0.5 * sum(a * b for a, b in zip(z, alpha))
+                   - sum(math.log(L[i][i]) for i in range(len(z))))
+            if best is None or lml > best[0]:
+                best = (lml, ell, L, alpha)
+        if best is None:
+            raise RuntimeError("GP fit failed (kernel matrix not positive definite)")
+        _, self.ell, self.L, self.alpha = best
+        return self
+
+    @staticmethod
+    def _k(a, b, ell):
+        return math.exp(-0.5 * sum((p - q) ** 2 for p, q in zip(a, b)) / (ell * ell))
+
+    def predict(self, x):
+        ks = [self._k(x, b, self.ell) for b in self.X]
+        mu = sum(k * a for k, a in zip(ks, self.alpha))
+        v = _solve_lower(self.L, ks)
+        var = max(1.0 - sum(t * t for t in v), 1e-12)
+        return self.mean + self.std * mu, self.std * math.sqrt(var)
+
+
+def expected_improvement(mu, sigma, best):
+    # 最小化：EI = (best-mu)Φ(z) + σφ(z)
+    z = (best - mu) / sigma
+    cdf = 0.5 * (1.0 + math.erf(z / math.sqrt(2.0)))
+    pdf = math.exp(-0.5 * z * z) / math.sqrt(2.0 * math.pi)
+    return (best - mu) * cdf + sigma * pdf
+
+
+# -- ParEGO ---------------------------------------------------------------------
+
+def encode(recipe, components):
+    out = []
+    for c in components:
+        span = float(c['max']) - float(c['min'])
+        out.append((recipe[c['name']] - float(c['min'])) / span if span > 0 else 0.0)
+    return out
+
+
+def random_weights(m, rng):
+    w = [-math.log(1.0 - rng.random()) for _ in range(m)]
+    s = sum(w)
+    return [v / s for v in w]
+
+
+def propose_batch(observed, components, cfg, rng, iteration):
+    """observed: [(配方, 目标值, 误差)]；返回 batch_size 个新配方"""
+    m = len(observed[0][1])
+    lo = [min(o[1][k] for o in observed) for k in range(m)]
+    hi = [max(o[1][k] for o in observed) for k in range(m)]
+    span = [(h - l) if h > l else 1.0 for l, h in zip(lo, hi)]
+    X = [encode(o[0], components) for o in observed]
+    seen = {tuple(round(o[0][c['name']], 6) for c in components) for o in observed}
+    candidates = [r for r in recipe_space.sample_combinations(components, int(cfg.get('candidates', 2000)), 'halton',
+                                                              seed=int(cfg.get('seed', 1)) * 1000 + iteration,
+                                                              decimals=int(cfg.get('decimals', 1)))
+                  if tuple(round(r[c['name']], 6) for c in components) not in seen]
+    batch = []
+    for _ in range(int(cfg.get('batch_size', 4))):
+        if not candidates:
+            break
+        w = random_weights(m, rng)
+        # 增广Tchebycheff（ParEGO，ρ=0.05）；误差按最大权重近似传递
+        y, noise = [], []
+        for o in observed:
+            f = [(o[1][k] - lo[k]) / span[k] for k in range(m)]
+            y.append(max(w[k] * f[k] for k in range(m)) + 0.05 * sum(w[k] * f[k] for k in range(m)))
+            noise.append(max(w[k] * o[2][k] / span[k] for k in range(m)))
+        gp = GaussianProcess().fit(X, y, noise)
+        best = min(y)
+        scored = max(((expected_improvement(*gp.predict(encode(r, components)), best), idx)
+                      for idx, r in enumerate(candidates)), key=lambda t: t[0])
+        batch.append(candidates.pop(scored[1]))
+    return batch
+
+
+# -- 历史 -----------------------------------------------------------------------
+
+def history_header(components, objectives):
+    names = [c['name'] for c in components]
+    # 取 log 的目标列名带 log10 前缀：变换不同的旧历史不会被当作同一目标读入
+    obj_names = [("log10:" if o.get('log', False) else "") + f"{o['source']}:{o['tally']}"
+                 for o in objectives]
+    return ["iteration", "tag"] + names + obj_names + [f"err:{n}" for n in obj_names] + ["pareto"]
+
+
+def write_history(path, rows, components, objectives):
+    names = [c['name'] for c in components]
+    mask = pareto_mask([r[2] for r in rows]) if rows else []
+    with open(path, 'w') as f:
+        f.write(",".join(history_header(components, objectives)) + "\n")
+        for (it, recipe, values, errors), front in zip(rows, mask):
+            f.write(f"{it},{recipe_tag(recipe)}," + ",".join(f"{recipe[n]:g}" for n in names) + ","
+                    + ",".join(f"{v:.6g}" for v in values) + "," + ",".join(f"{e:.3g}" for e in errors)
+                    + f",{int(front)}\n")
+
+
+def load_history(path, components, objectives):
+    rows = []
+    if not os.path.isfile(path):
+        return rows
+    names = [c['name'] for c in components]
+    m = len(objectives)
+    with open(path) as f:
+        # 组分与目标（源:计分量及变换）的列名都须一致，否则旧值的含义不同
+        header = f.readline().strip().split(',')
+        if header != history_header(components, objectives):
+            print(f"[OPT] history {path} does not match this configuration; ignored")
+            return rows
+        for line in f:
+            cells = line.strip().split(',')
+            recipe = {n: float(v) for n, v in zip(names, cells[2:2 + len(names)])}
+            values = [float(v) for v in cells[2 + len(names):2 + len(names) + m]]
+            errors = [float(v) for v in cells[2 + len(names) + m:2 + len(names) + 2 * m]]
+            rows.append((int(cells[0]), recipe, values, errors))
+    return rows
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    cfg = load_config(sys.argv[1])
+    dry_run = '--dry-run' in sys.argv or bool(cfg.get('dry_run', False))
+    components = cfg.get('components', [])
+    objectives = cfg.get('objectives') or [
+        {"source": cfg['sources'][0]['name'], "tally": "gamma", "sense": "min"},
+        {"source": cfg['sources'][-1]['name'], "tally": "neutron", "sense": "min"}]
+    for obj in objectives:
+        if obj.get('log', False) and obj['tally'] not in COUNT_TALLIES and 'floor' not in obj:
+            print(f"[ERROR] objective {obj['source']}:{obj['tally']} has \"log\": true but no \"floor\"")
+            sys.exit(1)
+    history = cfg.get('history') or os.path.join(RECIPES_DIR, 'optimize_history.csv')
+    if not os.path.isabs(history):
+        history = os.path.join(ROOT_DIR, history)
+    rng = random.Random(int(cfg.get('seed', 1)))
+
+    rebuild()
+    if not os.path.isfile(BUILD_EXE) and not dry_run:
+        print(f"[ERROR] Not found executable: {BUILD_EXE}")
+        sys.exit(2)
+    os.makedirs(RECIPES_DIR, exist_ok=True)
+
+    rows = load_history(history, components, objectives) if cfg.get('resume', True) else []
+    n_sims = 0
+    n_sources = len(cfg.get('sources', []))
+    start = max((r[0] for r in rows), default=-1) + 1
+    # 第0轮为初始设计；续算时只做 iterations 轮新的提议
+    n_rounds = int(cfg.get('iterations', 8)) + (1 if start == 0 else 0)
+    for it in range(start, start + n_rounds):
+        if it == 0:
+            batch = list(recipe_space.sample_combinations(components, int(cfg.get('initial_points', 12)), 'lhs',
+                                                          seed=int(cfg.get('seed', 1)),
+                                                          decimals=int(cfg.get('decimals', 1))))
+        else:
+            observed = [(r[1], r[2], r[3]) for r in rows]
+            if len(observed) < 2:
+                print("[OPT] fewer than 2 completed points; cannot fit the surrogate")
+                break
+            batch = propose_batch(observed, components, cfg, rng, it)
+        if not batch:
+            print("[OPT] no new candidates left")
+            break
+        print(f"[OPT] iteration {it}: {len(batch)} recipes x {n_sources} sources")
+        results = evaluate_batch(batch, cfg, dry_run)
+        n_sims += len(batch) * n_sources
+        for recipe, result in zip(batch, results):
+            ov = objective_values(result, objectives)
+            if ov is None:
+                print(f"[WARN] {recipe_tag(recipe)}: missing tallies, not used by the surrogate")
+                continue
+            rows.append((it, recipe, ov[0], ov[1]))
+        if dry_run:
+            print("[DRY] stopping after the first batch (no results to fit)")
+            break
+        write_history(history, rows, components, objectives)
+        front = [r for r, f in zip(rows, pareto_mask([r[2] for r in rows])) if f]
+        print(f"[OPT] {len(rows)} evaluated recipes ({n_sims} simulations this session), "
+              f"{len(front)} on the Pareto front; history in {history}")
+
+    if rows:
+        print("[OPT] Pareto front (objectives as minimized: log10 and sign applied):")
+        for it, recipe, values, _ in [r for r, f in zip(rows, pareto_mask([r[2] for r in rows])) if f]:
+            print("  " + " ".join(f"{v:9.4f}" for v in values) + "  "
+                  + " ".join(f"{k}={v:g}" for k, v in recipe.items()) + f"  (iteration {it})")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+配方空间：质量百分比之和为100、每个组分有上下限的单纯形（sweep_recipes.py 使用）。
+
+- 网格（缺省）：逐组分在 [min, max] 上按 step 取值，直接在约束单纯形上枚举，
+  与“笛卡尔积再按总和筛选”得到同一组配方，但每一步只遍历剩余组分仍能补足到
+  100±sum_tolerance 的取值区间（后缀最小/最大和剪枝，最后一个组分用二分直接求区间），
+  耗时与结果数成正比，而不是与所有组分网格点数之积成正比。
+- 采样：在有界单纯形上取 n 个点，method 为
+    "lhs"    拉丁超立方（每维分层、随机排列）
+    "halton" Halton 低差异序列（随机平移，按 seed 可复现）
+    "random" 独立均匀随机数
+  单位立方体中的点逐维映射到单纯形：第 i 个组分在剩余量 R 中的份额按
+  Beta(1, k-1)（k 为剩余组分数，即均匀单纯形的边缘分布）的逆CDF取值，并截断到
+  由本组分上下限和其余组分上下限共同决定的可行区间，因此每个点都满足约束、
+  无需拒绝采样；上下限很紧时分布只是近似均匀。结果按 decimals 位小数取整，
+  取整误差由最后一个仍有余量的组分吸收，重复点去掉。
+
+JSON 配置（sweep_recipes.py）："sampling": {"method": "lhs", "n": 500, "seed": 1, "decimals": 2}
+缺省或 method 为 "grid" 时使用网格枚举。
+
+单独使用（打印配方数或前几个配方）：
+  recipe_space.py <config.json> [--show N]
+"""
+import sys
+import json
+import math
+import random
+from bisect import bisect_left, bisect_right
+
+TOTAL = 100.0
+EPS = 1e-9
+
+
+def frange(min_v, max_v, step):
+    v = min_v
+    while v <= max_v + 1e-9:
+        yield round(v, 6)
+        v += step
+
+
+def _suffix_bounds(lows, highs):
+    """suf_min[i] / suf_max[i]：组分 i.. 末尾的下限和 / 上限和"""
+    n = len(lows)
+    suf_min = [0.0] * (n + 1)
+    suf_max = [0.0] * (n + 1)
+    for i in range(n - 1, -1, -1):
+        suf_min[i] = suf_min[i + 1] + lows[i]
+        suf_max[i] = suf_max[i + 1] + highs[i]
+    return suf_min, suf_max
+
+
+def generate_combinations(components, sum_tolerance):
+    """约束单纯形上的网格配方：逐组分按剩余可行区间取值（生成器，按组分顺序字典序）"""
+    names = [c['name'] for c in components]
+    grids = [list(frange(c['min'], c['max'], c['step'])) for c in components]
+    if not grids or any(not g for g in grids):
+        return
+    suf_min, suf_max = _suffix_bounds([g[0] for g in grids], [g[-1] for g in grids])
+    n = len(grids)
+    values = [0.0] * n
+
+    def recurse(i, partial):
+        # 组分 i 的取值 v 须使余下组分仍能补足：TOTAL-tol <= partial+v+rest <= TOTAL+tol
+        lo = TOTAL - sum_tolerance - partial - suf_max[i + 1]
+        hi = TOTAL + sum_tolerance - partial - suf_min[i + 1]
+        grid = grids[i]
+        for v in grid[bisect_left(grid, lo - EPS):bisect_right(grid, hi + EPS)]:
+            values[i] = v
+            if i + 1 == n:
+                yield dict(zip(names, values))
+            else:
+                yield from recurse(i + 1, partial + v)
+
+    yield from recurse(0, 0.0)
+
+
+def count_combinations(components, sum_tolerance):
+    return sum(1 for _ in generate_combinations(components, sum_tolerance))
+
+
+# -- 采样 ---------------------------------------------------------------------
+
+_PRIMES = [2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71]
+
+
+def _radical_inverse(index, base):
+    inv, f = 0.0, 1.0 / base
+    while index > 0:
+        inv += f * (index % base)
+        index //= base
+        f /= base
+    return inv
+
+
+def unit_points(n, dim, method='lhs', seed=1):
+    """[0,1)^dim 中的 n 个点"""
+    rng = random.Random(seed)
+    if method == 'lhs':
+        cols = []
+        for _ in range(dim):
+            strata = list(range(n))
+            rng.shuffle(strata)
+            cols.append([(s + rng.random()) / n for s in strata])
+        return [[cols[d][i] for d in range(dim)] for i in range(n)]
+    if method == 'halton':
+        if dim > len(_PRIMES):
+            raise ValueError(f"halton sampling supports at most {len(_PRIMES) + 1} components")
+        shift = [rng.random() for _ in range(dim)]
+        skip = 20  # 跳过起始段（各维在前几个点高度相关）
+        return [[(_radical_inverse(i + skip, _PRIMES[d]) + shift[d]) % 1.0 for d in range(dim)]
+                for i in range(n)]
+    if method == 'random':
+        return [[rng.random() for _ in range(dim)] for _ in range(n)]
+    raise ValueError(f"unknown sampling method '{method}' (grid, lhs, halton or random)")
+
+
+def map_to_simplex(u, lows, highs, total=TOTAL):
+    """单位立方体的点（维数 = 组分数-1）→ 满足上下限且和为 total 的组分值"""
+    n = len(lows)
+    suf_min, suf_max = _suffix_bounds(lows, highs)
+    x = []
+    remaining = total
+    for i in range(n - 1):
+        lo = max(lows[i], remaining - suf_max[i + 1])
+        hi = min(highs[i], remaining - suf_min[i + 1])
+        if hi < lo:
+            return None
+        k = n - i  # 剩余组分数（含本组分）
+        # 均匀单纯形上份额 t 的边缘分布 Beta(1, k-1)：F(t) = 1 - (1-t)^(k-1)
+        cdf = lambda t: 1.0 - (1.0 - min(max(t, 0.0), 1.0)) ** (k - 1)
+        if remaining > EPS:
+            f_lo, f_hi = cdf(lo / remaining), cdf(hi / remaining)
+            p = f_lo + u[i] * (f_hi - f_lo)
+            v = remaining * (1.0 - (1.0 - p) ** (1.0 / (k - 1)))
+        else:
+            v = lo
+        v = min(max(v, lo), hi)
+        x.append(v)
+        remaining -= v
+    if remaining < lows[-1] - EPS or remaining > highs[-1] + EPS:
+        return None
+    x.append(remaining)
+    return x
+
+
+def _round_recipe(x, lows, highs, decimals, total=TOTAL):
+    r = [round(v, decimals) for v in x]
+    diff = round(total - sum(r), decimals)
+    # 取整误差由最后一个仍有余量的组分吸收
+    for i in range(len(r) - 1, -1, -1):
+        v = round(r[i] + diff, decimals)
+        if lows[i] - EPS <= v <= highs[i] + EPS:
+            r[i] = v
+            return r
+    return None
+
+
+def sample_combinations(components, n, method='lhs', seed=1, decimals=2):
+    """有界单纯形上的 n 个采样配方（去重后可能略少于 n）"""
+    names = [c['name'] for c in components]
+    lows = [float(c['min']) for c in components]
+    highs = [float(c['max']) for c in components]
+    if sum(lows) > TOTAL + EPS or sum(highs) < TOTAL - EPS:
+        raise ValueError(f"bounds cannot sum to {TOTAL}: sum(min)={sum(lows)}, sum(max)={sum(highs)}")
+    seen = set()
+    for u in unit_points(int(n), len(components) - 1, method, seed):
+        x = map_to_simplex(u, lows, highs)
+        x = _round_recipe(x, lows, highs, decimals) if x else None
+        if x is None or tuple(x) in seen:
+            continue
+        seen.add(tuple(x))
+        yield dict(zip(names, x))
+
+
+def recipes_from_config(cfg):
+    """按配置选择网格枚举或采样"""
+    components = cfg.get('components', [])
+    sampling = cfg.get('sampling') or {}
+    method = sampling.get('method', 'grid')
+    if method == 'grid':
+        return generate_combinations(components, float(cfg.get('sum_tolerance', 0.5)))
+    return sample_combinations(components, sampling.get('n', 100), method,
+                               sampling.get('seed', 1), sampling.get('decimals', 2))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    with open(sys.argv[1]) as f:
+        cfg = json.load(f)
+    show = int(sys.argv[sys.argv.index('--show') + 1]) if '--show' in sys.argv else 0
+    count = 0
+    for recipe in recipes_from_config(cfg):
+        if count < show:
+            print(" ".join(f"{k}={v:g}" for k, v in recipe.items()))
+        count += 1
+    grid = math.prod(len(list(frange(c['min'], c['max'], c['step']))) for c in cfg.get('components', [])
+                     if 'step' in c)
+    print(f"{count} recipes (Cartesian grid would have {grid} points)")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+"""
+结果缓存：按 (配方, 源宏, 物理/环境设置, 事件数) 复用已有的 exampleB1 输出，
+并把同配置、不同随机数种子的run合并（续算而不是重算）。
+
+作业键 job_key：生成的运行宏在展开 /control/execute 后的规范化命令
+（去注释与多余空白，去掉 /run/beamOn、/random/、/metadata/、/control/），
+其中 /det/glass/compositionFile 换成配方内容（同名合并、归一化、按名称排序，
+与 GlassMaterialRegistry 的配方哈希同样与文件路径/组分顺序/倍数无关），
+再加上影响物理的环境变量。事件数与种子不在键里。
+sweep_recipes.py 把键写进宏（/metadata/jobKey），exampleB1 在run完整结束时写出
+run_metadata.json（job_key、config_hash、events、seeds、stop_reason），本模块据此查找：
+  - 命中：某个run实际处理的事件数 ≥ 需要的事件数，或该run因达到收敛目标提前停止
+    （stop_reason = converged）
+  - 续算：CPU预算耗尽（cpu_budget）或中止（aborted）的run事件数不足，
+    只补跑差额（新种子），再与已有run合并
+  - 未命中：正常运行
+exampleB1 的 config_hash（由UI历史计算）用来核对：只有 config_hash 相同的run才合并。
+
+命令行：
+  result_cache.py list [data_dir]                      列出带元数据的run
+  result_cache.py lookup <job_key> <events> [data_dir]
+  result_cache.py merge <out_dir> <run_dir> <run_dir> ...
+"""
+import os
+import sys
+import json
+import math
+import glob
+import shutil
+import hashlib
+import subprocess
+from datetime import datetime
+
+from data_paths import data_dir
+
+ROOT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# 与 RunConfiguration.cc 的 kPhysicsEnv 一致
+PHYSICS_ENV = ["EM_PHYSICS_OPTION", "NGAMMA_SOURCE_MODE", "NGAMMA_SRIM_ED_FILE",
+               "NGAMMA_IMPORTANCE_LAYERS", "NGAMMA_IMPORTANCE_VALUES", "NGAMMA_IMPORTANCE_BASE",
+               "NGAMMA_BIAS_PARTICLES", "NGAMMA_WW_FILE", "NGAMMA_RESPONSE_MATRIX"]
+IGNORED_PREFIXES = ("/run/beamOn", "/random/", "/metadata/", "/control/")
+
+# master在run结束时填入的“每个源粒子均值”直方图：合并时按事件数加权平均，而不是相加
+PER_PRIMARY_HISTOGRAMS = ["Neutron_Fluence", "Gamma_Fluence",
+                          "Neutron_Depth_Transmit_E", "Gamma_Depth_Transmit_E", "Depth_Plane_mm"]
+
+
+def parse_recipe_line(line):
+    """与 GlassMaterialRegistry::GetGlassFromFile 相同的语法：
+    "<氧化物> <百分比>[%] [# 注释]"，百分号可紧跟数值或单独成词。
+    空行与注释行返回 None，格式错误（exampleB1 拒绝整个配方）抛 ValueError"""
+    tokens = line.split()
+    if not tokens or tokens[0].startswith('#'):
+        return None
+    if len(tokens) < 2:
+        raise ValueError(line)
+    value, rest = tokens[1], tokens[2:]
+    if value.endswith('%'):
+        value = value[:-1]
+    elif rest and rest[0] == '%':
+        rest = rest[1:]
+    pct = float(value)
+    if not math.isfinite(pct) or pct < 0 or (rest and not rest[0].startswith('#')):
+        raise ValueError(line)
+    return tokens[0].lower(), pct
+
+
+def normalized_recipe(path):
+    parts = {}
+    try:
+        with open(path) as f:
+            for lineno, line in enumerate(f, 1):
+                try:
+                    part = parse_recipe_line(line)
+                except ValueError:
+                    # exampleB1 不会运行这个配方：键里不放任何可能与有效配方相同的内容
+                    return f"invalid:{path}:{lineno}"
+                if part and part[1] > 0:
+                    name, pct = part
+                    parts[name] = parts.get(name, 0.0) + pct
+    except OSError:
+        return f"missing:{path}"
+    total = sum(parts.values())
+    return ";".join(f"{name}:{pct / total:.9f}" for name, pct in sorted(parts.items()))
+
+
+def _expand_macro(path, out, depth=0):
+    if depth > 16:
+        return
+    base = os.path.dirname(path)
+    with open(path) as f:
+        for raw in f:
+            line = " ".join(raw.split())
+            if not line or line.startswith('#'):
+                continue
+            if line.startswith('/control/execute '):
+                sub = line.split(None, 1)[1]
+                for cand in (sub, os.path.join(base, sub), os.path.join(ROOT_DIR, sub)):
+                    if os.path.isfile(cand):
+                        _expand_macro(cand, out, depth + 1)
+                        break
+                else:
+                    out.append(line)
+                continue
+            if line.startswith('/det/glass/compositionFile '):
+                out.append("recipe:" + normalized_recipe(line.split(None, 1)[1]))
+                continue
+            if line.startswith(IGNORED_PREFIXES):
+                continue
+            out.append(line)
+
+
+def job_key(macro_path, env=None):
+    """运行宏 + 环境 → 16位十六进制作业键（不含事件数与种子）"""
+    env = env if env is not None else os.environ
+    lines = []
+    _expand_macro(macro_path, lines)
+    for name in PHYSICS_ENV:
+        lines.append(f"env:{name}={env.get(name, '')}")
+    return hashlib.sha256("\n".join(lines).encode()).hexdigest()[:16]
+
+
+def load_runs(base=None):
+    runs = []
+    for meta_path in glob.glob(os.path.join(base or data_dir(), '*', 'run_metadata.json')):
+        try:
+            with open(meta_path) as f:
+                meta = json.load(f)
+        except (OSError, ValueError):
+            continue
+        meta['dir'] = os.path.dirname(os.path.abspath(meta_path))
+        runs.append(meta)
+    return runs
+
+
+def lookup(key, events, base=None):
+    """返回 (状态, 数据)：('hit', run目录) / ('extend', (已有run列表, 差额事件数)) / ('miss', None)"""
+    runs = [r for r in load_runs(base) if r.get('job_key') == key and not r.get('merged_from')]
+    merged = [r for r in load_runs(base) if r.get('job_key') == key and r.get('merged_from')]
+    # 收敛提前停止的run已达到目标精度（目标在作业键里）；
+    # CPU预算或中止提前结束的run只按实际处理的事件数判断，不足时由续算补足差额
+    for r in sorted(runs + merged, key=lambda r: r.get('events', 0), reverse=True):
+        if r.get('events', 0) >= events or r.get('stop_reason') == 'converged':
+            return 'hit', r['dir']
+    if not runs:
+        return 'miss', None
+    # 只合并与最大那次run的 config_hash 相同的部分
+    ref = max(runs, key=lambda r: r.get('events', 0))
+    compatible = [r for r in runs if r.get('config_hash') == ref.get('config_hash')]
+    have = sum(r.get('events', 0) for r in compatible)
+    if have >= events:
+        return 'extend', (compatible, 0)
+    return 'extend', (compatible, events - have)
+
+
+def seed_offset(key, base=None):
+    """续算用的序号：已有run数（种子由键与序号导出，保证与已有run不同）"""
+    return sum(1 for r in load_runs(base) if r.get('job_key') == key and not r.get('merged_from'))
+
+
+# -- 合并 -------------------------------------------------------------------
+
+def _merge_tally_statistics(run_dirs, out_dir):
+    """tally_statistics.txt：均值按事件数加权；R 由各run的方差合成；FOM 不再有意义（置0）"""
+    acc = {}
+    total = 0
+    for d in run_dirs:
+        path = os.path.join(d, 'tally_statistics.txt')
+        meta = json.load(open(os.path.join(d, 'run_metadata.json')))
+        n = meta.get('events', 0)
+        if not os.path.isfile(path) or n <= 0:
+            continue
+        total += n
+        for line in open(path):
+            if line.startswith('#'):
+                continue
+            name, mean, rel = line.split()[:3]
+            mean, rel = float(mean), float(rel)
+            s, var = acc.get(name, (0.0, 0.0))
+            # 总和 = sum(N_i m_i)，其方差 = sum((N_i m_i R_i)^2)
+            acc[name] = (s + n * mean, var + (n * mean * rel) ** 2)
+    if not acc:
+        return
+    with open(os.path.join(out_dir, 'tally_statistics.txt'), 'w') as f:
+        f.write(f"# merged per-history statistics; events = {total}; runs = {len(run_dirs)}\n")
+        f.write("# tally mean_per_history rel_err fom_per_min\n")
+        for name, (s, var) in acc.items():
+            rel = (var ** 0.5) / s if s > 0 else 0.0
+            f.write(f"{name} {s / total:e} {rel:e} 0\n")
+
+
+def _fix_per_primary(run_dirs, events, merged_root):
+    import ROOT
+    out = ROOT.TFile.Open(merged_root, "UPDATE")
+    total = float(sum(events))
+    for name in PER_PRIMARY_HISTOGRAMS:
+        merged = None
+        for d, n in zip(run_dirs, events):
+            f = ROOT.TFile.Open(os.path.join(d, 'scintillator_output.root'))
+            h = f.Get(name) if f else None
+            if h:
+                if merged is None:
+                    out.cd()
+                    merged = h.Clone(name)
+                    merged.Reset()
+                merged.Add(h, n / total)
+            if f:
+                f.Close()
+        if merged is not None:
+            out.cd()
+            merged.Write(name, ROOT.TObject.kOverwrite)
+    out.Close()
+
+
+def merge_runs(run_dirs, out_dir):
+    """hadd 合并ROOT文件并改正按源粒子均值的直方图；写出合并后的元数据。
+    没有 PyROOT 时无法改正（hadd 只会相加），直接报错，不留下元数据与索引记录"""
+    try:
+        import ROOT  # noqa: F401
+    except ImportError:
+        raise RuntimeError("PyROOT not available: per-primary histograms "
+                           f"({', '.join(PER_PRIMARY_HISTOGRAMS)}) cannot be averaged; refusing to merge")
+    metas = [json.load(open(os.path.join(d, 'run_metadata.json'))) for d in run_dirs]
+    hashes = {m.get('config_hash') for m in metas}
+    if len(hashes) > 1:
+        raise ValueError(f"runs have different config_hash {sorted(hashes)}; refusing to merge")
+    seeds = [m.get('seeds') for m in metas]
+    if len(set(seeds)) < len(seeds):
+        print(f"[CACHE] WARNING: repeated seeds {seeds}; merged runs are not independent")
+
+    os.makedirs(out_dir, exist_ok=True)
+    merged_root = os.path.join(out_dir, 'scintillator_output.root')
+    inputs = [os.path.join(d, 'scintillator_output.root') for d in run_dirs]
+    events = [m.get('events', 0) for m in metas]
+    try:
+        rc = subprocess.call(['hadd', '-f', merged_root] + inputs)
+        if rc != 0:
+            raise RuntimeError(f"hadd failed ({rc})")
+        _fix_per_primary(run_dirs, events, merged_root)
+    except Exception:
+        # 半成品目录没有 run_metadata.json，不会被当作结果；仍一并删除
+        shutil.rmtree(out_dir, ignore_errors=True)
+        raise
+    _merge_tally_statistics(run_dirs, out_dir)
+    comp = os.path.join(run_dirs[0], 'composition.txt')
+    if os.path.isfile(comp):
+        shutil.copyfile(comp, os.path.join(out_dir, 'composition.txt'))
+
+    merged = dict(metas[0])
+    merged.pop('dir', None)
+    merged.update({'events': sum(events),
+                   'events_requested': sum(events),
+                   'stop_reason': 'merged',
+                   'seeds': ";".join(str(s) for s in seeds),
+                   'merged_from': [os.path.basename(d) for d in run_dirs]})
+    with open(os.path.join(out_dir, 'run_metadata.json'), 'w') as f:
+        json.dump(merged, f, indent=2)
+    _catalog_merged(run_dirs, out_dir, merged)
+    print(f"[CACHE] merged {len(run_dirs)} runs ({sum(events)} events) -> {out_dir}")
+    return out_dir
+
+
+def _catalog_merged(run_dirs, out_dir, merged):
+    """合并目录也写进运行目录索引：源等字段沿用第一个run的索引记录，计分量取合成后的值"""
+    import run_catalog
+    base = os.path.dirname(os.path.abspath(out_dir))
+    record = {}
+    try:
+        db, _ = run_catalog.sync(base)
+        row = db.execute(f"SELECT {', '.join(run_catalog.RUN_FIELDS)} FROM runs WHERE dir = ?",
+                         (os.path.abspath(run_dirs[0]),)).fetchone()
+        if row:
+            record = dict(zip(run_catalog.RUN_FIELDS, row))
+    except Exception as e:
+        print(f"[CACHE] run catalog not readable ({e}); merged entry has metadata only")
+    record.update({k: merged.get(k) for k in ('config_hash', 'job_key', 'events', 'events_requested', 'seeds')})
+    record.update({'time': datetime.now().strftime('%Y-%m-%dT%H:%M:%S'), 'dir': os.path.abspath(out_dir),
+                   'root_file': os.path.join(os.path.abspath(out_dir), 'scintillator_output.root'),
+                   'merged': 1, 'merged_from': [os.path.abspath(d) for d in run_dirs],
+                   'cpu_s': None, 'dose_Gy': None, 'dose_rms_Gy': None})
+    tallies = {}
+    stats = os.path.join(out_dir, 'tally_statistics.txt')
+    if os.path.isfile(stats):
+        for line in open(stats):
+            if line.strip() and not line.startswith('#'):
+                name, mean, rel = line.split()[:3]
+                tallies[name] = [float(mean), float(rel)]
+    record['tallies'] = tallies
+    run_catalog.append_record(base, record)
+
+
+def merge_for_key(key, base=None):
+    """把某作业键下 config_hash 相容的全部独立run合并到新目录"""
+    base = base or data_dir()
+    runs = [r for r in load_runs(base) if r.get('job_key') == key and not r.get('merged_from')]
+    if len(runs) < 2:
+        return runs[0]['dir'] if runs else None
+    ref = max(runs, key=lambda r: r.get('events', 0))
+    runs = [r for r in runs if r.get('config_hash') == ref.get('config_hash')]
+    total = sum(r.get('events', 0) for r in runs)
+    ts = datetime.now().strftime('%Y%m%d_%H%M%S')
+    return merge_runs([r['dir'] for r in runs], os.path.join(base, f"merged_{key}_{total}ev_{ts}"))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    cmd = sys.argv[1]
+    if cmd == 'list':
+        for r in sorted(load_runs(sys.argv[2] if len(sys.argv) > 2 else None), key=lambda r: r['dir']):
+            tag = " merged" if r.get('merged_from') else ""
+            print(f"{r.get('job_key') or '-':16s} {r.get('config_hash', ''):16s} {r.get('events', 0):>10d} "
+                  f"{r.get('seeds', '')!s:24s} {os.path.basename(r['dir'])}{tag}")
+    elif cmd == 'lookup' and len(sys.argv) >= 4:
+        state, data = lookup(sys.argv[2], int(sys.argv[3]), sys.argv[4] if len(sys.argv) > 4 else None)
+        if state == 'extend':
+            runs, missing = data
+            print(f"extend {missing} events on top of {len(runs)} runs")
+        else:
+            print(state, data or "")
+    elif cmd == 'merge' and len(sys.argv) >= 5:
+        merge_runs(sys.argv[3:], sys.argv[2])
+    else:
+        print(__doc__)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+"""
+运行目录索引：把 exampleB1 每个run追加的 <data_dir>/run_catalog.jsonl 导入
+<data_dir>/run_catalog.sqlite，供跨run查询与汇总，分析宏不必 ls 数据目录或逐个打开ROOT文件。
+
+每条记录（RunConfiguration::AppendToCatalog 写出，一行JSON）：
+  time dir root_file run_id events events_requested threads particle source material
+  density_g_cm3 recipe_file glass_thickness_mm config_hash job_key seeds cpu_s dose_Gy dose_rms_Gy
+  tallies: {gamma|neutron|capture|dpa|edep|niel: [每历史均值, 相对误差]}
+result_cache.py 合并出的目录也追加一条（merged=1，merged_from 为被合并的run目录）。
+被合并的run与被更大的合并结果包含的旧合并结果记为 superseded：query/aggregate 缺省不计，
+同一批历史不会重复计入；--no-merged 只看独立run（含已被合并的），--all 不做这两种过滤。
+
+导入是增量的（记住已读到的字节位置）；每个查询命令先自动同步。
+scan 还会把索引出现之前的run目录（有 run_metadata.json 的）补进来。
+
+命令：
+  run_catalog.py sync [--scan]
+  run_catalog.py query [过滤] [--fields f1,f2,...] [--latest N] [--format tsv|csv|json]
+      过滤：--particle --source --material(子串) --job-key --config-hash --min-events
+            --thickness-mm --no-merged --all --where "<SQL条件>"
+      字段：runs 表的列，或 tally:<名称>（均值）、err:<名称>（相对误差）
+  run_catalog.py aggregate --tally gamma [--by material,glass_thickness_mm] [过滤]
+      同组run按事件数加权合成均值与相对误差
+  run_catalog.py sql "SELECT ..."
+所有命令接受 --data <数据目录>（缺省同 RunAction：NGAMMA_DATA_DIR 或 ~/ngamma/data，见 data_paths.py）。
+"""
+import os
+import sys
+import json
+import glob
+import sqlite3
+import argparse
+from datetime import datetime
+
+from data_paths import data_dir
+
+CATALOG_JSONL = 'run_catalog.jsonl'
+CATALOG_DB = 'run_catalog.sqlite'
+
+RUN_COLUMNS = [
+    ('time', 'TEXT'), ('dir', 'TEXT UNIQUE'), ('root_file', 'TEXT'), ('run_id', 'INTEGER'),
+    ('events', 'INTEGER'), ('events_requested', 'INTEGER'), ('threads', 'INTEGER'),
+    ('particle', 'TEXT'), ('source', 'TEXT'), ('material', 'TEXT'), ('density_g_cm3', 'REAL'),
+    ('recipe_file', 'TEXT'), ('glass_thickness_mm', 'REAL'), ('config_hash', 'TEXT'), ('job_key', 'TEXT'),
+    ('seeds', 'TEXT'), ('cpu_s', 'REAL'), ('dose_Gy', 'REAL'), ('dose_rms_Gy', 'REAL'), ('merged', 'INTEGER'),
+    ('superseded', 'INTEGER')]
+RUN_FIELDS = [name for name, _ in RUN_COLUMNS]
+
+
+def append_record(base, record):
+    """追加一行到 run_catalog.jsonl（与 exampleB1 相同的 flock 互斥）"""
+    line = json.dumps(record, ensure_ascii=False) + "\n"
+    with open(os.path.join(base, CATALOG_JSONL), 'a') as f:
+        try:
+            import fcntl
+            fcntl.flock(f, fcntl.LOCK_EX)
+        except ImportError:
+            pass
+        f.write(line)
+
+
+def connect(base):
+    db = sqlite3.connect(os.path.join(base, CATALOG_DB))
+    db.execute(f"CREATE TABLE IF NOT EXISTS runs (id INTEGER PRIMARY KEY, "
+               f"{', '.join(f'{n} {t}' for n, t in RUN_COLUMNS)})")
+    db.execute("CREATE TABLE IF NOT EXISTS tallies (run INTEGER, name TEXT, mean REAL, rel_err REAL, "
+               "PRIMARY KEY (run, name))")
+    db.execute("CREATE TABLE IF NOT EXISTS members (run INTEGER, dir TEXT)")
+    db.execute("CREATE TABLE IF NOT EXISTS meta (key TEXT PRIMARY KEY, value TEXT)")
+    # 旧索引库没有 superseded 列
+    if 'superseded' not in {r[1] for r in db.execute("PRAGMA table_info(runs)")}:
+        db.execute("ALTER TABLE runs ADD COLUMN superseded INTEGER DEFAULT 0")
+    for column in ('particle', 'material', 'job_key', 'config_hash', 'glass_thickness_mm'):
+        db.execute(f"CREATE INDEX IF NOT EXISTS idx_runs_{column} ON runs ({column})")
+    return db
+
+
+def _abs_run_dir(path, base):
+    """run目录统一为绝对路径。相对 NGAMMA_DATA_DIR 下写出的旧记录是相对路径：
+    run目录都直接位于数据目录下，按目录名在 base 中定位"""
+    if path and not os.path.isabs(path):
+        path = os.path.join(base, os.path.basename(os.path.normpath(path)))
+    return os.path.normpath(path) if path else path
+
+
+def _insert(db, record, base):
+    # 与 result_cache.py 一样按绝对路径匹配目录
+    record = dict(record)
+    record['dir'] = _abs_run_dir(record.get('dir'), base)
+    if record.get('root_file') and not os.path.isabs(record['root_file']):
+        record['root_file'] = os.path.join(record['dir'], os.path.basename(record['root_file']))
+    record['merged_from'] = [_abs_run_dir(d, base) for d in record.get('merged_from') or []]
+    # 同一目录重复记录（如补扫描）时替换旧行
+    old = db.execute("SELECT id FROM runs WHERE dir = ?", (record.get('dir'),)).fetchone()
+    if old:
+        db.execute("DELETE FROM tallies WHERE run = ?", old)
+        db.execute("DELETE FROM members WHERE run = ?", old)
+        db.execute("DELETE FROM runs WHERE id = ?", old)
+    values = [record.get(name) for name in RUN_FIELDS]
+    values[RUN_FIELDS.index('merged')] = int(bool(record.get('merged')))
+    values[RUN_FIELDS.index('superseded')] = 0
+    cur = db.execute(f"INSERT OR REPLACE INTO runs ({', '.join(RUN_FIELDS)}) "
+                     f"VALUES ({', '.join('?' * len(RUN_FIELDS))})", values)
+    run = cur.lastrowid
+    for name, (mean, rel) in (record.get('tallies') or {}).items():
+        db.execute("INSERT INTO tallies VALUES (?, ?, ?, ?)", (run, name, mean, rel))
+    for member in record.get('merged_from') or []:
+        db.execute("INSERT INTO members VALUES (?, ?)", (run, member))
+
+
+def _mark_superseded(db):
+    """被合并的run，以及成员被另一合并结果完全包含的合并结果，标记为 superseded"""
+    db.execute("UPDATE runs SET superseded = 0")
+    db.execute("UPDATE runs SET superseded = 1 WHERE dir IN (SELECT dir FROM members)")
+    groups = {}
+    for run, member in db.execute("SELECT run, dir FROM members"):
+        groups.setdefault(run, set()).add(member)
+    for run, dirs in groups.items():
+        if any(other != run and dirs < others for other, others in groups.items()):
+            db.execute("UPDATE runs SET superseded = 1 WHERE id = ?", (run,))
+
+
+def sync(base, scan=False):
+    base = os.path.abspath(base)
+    db = connect(base)
+    path = os.path.join(base, CATALOG_JSONL)
+    row = db.execute("SELECT value FROM meta WHERE key = 'jsonl_offset'").fetchone()
+    offset = int(row[0]) if row else 0
+    added = 0
+    if os.path.isfile(path):
+        if os.path.getsize(path) < offset:
+            offset = 0  # 文件被截断或替换：从头读
+        with open(path, 'rb') as f:
+            f.seek(offset)
+            for raw in f:
+                if not raw.endswith(b"\n"):
+                    break  # 正在写的半行留到下次
+                offset += len(raw)
+                try:
+                    _insert(db, json.loads(raw), base)
+                    added += 1
+                except ValueError:
+                    print(f"[CATALOG] skipped malformed line at byte {offset - len(raw)}", file=sys.stderr)
+        db.execute("INSERT OR REPLACE INTO meta VALUES ('jsonl_offset', ?)", (str(offset),))
+    if scan:
+        added += _scan_dirs(db, base)
+    if added:
+        _mark_superseded(db)
+    db.commit()
+    return db, added
+
+
+def _scan_dirs(db, base):
+    """把没有索引记录的run目录（run_metadata.json 存在）补进来"""
+    known = {r[0] for r in db.execute("SELECT dir FROM runs")}
+    added = 0
+    for meta_path in glob.glob(os.path.join(base, '*', 'run_metadata.json')):
+        run_dir = os.path.dirname(meta_path)
+        if run_dir in known:
+            continue
+        try:
+            meta = json.load(open(meta_path))
+        except (OSError, ValueError):
+            continue
+        record = {k: meta.get(k) for k in ('config_hash', 'job_key', 'events', 'events_requested',
+                                           'seeds', 'run_id', 'threads')}
+        mtime = datetime.fromtimestamp(os.path.getmtime(meta_path)).strftime('%Y-%m-%dT%H:%M:%S')
+        record.update({'time': mtime, 'dir': run_dir, 'root_file': os.path.join(run_dir, 'scintillator_output.root'),
+                       'merged': bool(meta.get('merged_from')),
+                       'merged_from': [os.path.abspath(os.path.join(base, d)) for d in meta.get('merged_from') or []],
+                       'particle': os.path.basename(run_dir).split('_')[0]})
+        for line in meta.get('config', []):
+            if line.startswith('glass='):
+                record['material'] = line[6:]
+            elif line.startswith('glassThickness_mm='):
+                record['glass_thickness_mm'] = float(line.split('=', 1)[1])
+        tallies = {}
+        stats = os.path.join(run_dir, 'tally_statistics.txt')
+        if os.path.isfile(stats):
+            for line in open(stats):
+                if line.strip() and not line.startswith('#'):
+                    name, mean, rel = line.split()[:3]
+                    tallies[name] = [float(mean), float(rel)]
+        record['tallies'] = tallies
+        _insert(db, record, base)
+        added += 1
+    return added
+
+
+# -- 查询 -----------------------------------------------------------------------
+
+def _filters(args):
+    where, params = [], []
+    for field, value in (('particle', args.particle), ('source', args.source),
+                         ('job_key', args.job_key), ('config_hash', args.config_hash)):
+        if value:
+            where.append(f"runs.{field} = ?")
+            params.append(value)
+    if args.material:
+        where.append("runs.material LIKE ?")
+        params.append(f"%{args.material}%")
+    if args.min_events:
+        where.append("runs.events >= ?")
+        params.append(args.min_events)
+    if args.thickness_mm is not None:
+        where.append("ABS(runs.glass_thickness_mm - ?) < 1e-6")
+        params.append(args.thickness_mm)
+    if args.no_merged:
+        where.append("runs.merged = 0")
+    elif not args.all:
+        where.append("runs.superseded = 0")
+    if args.where:
+        where.append(f"({args.where})")
+    return (" WHERE " + " AND ".join(where)) if where else "", params
+
+
+def _select_expr(field):
+    if field.startswith('tally:') or field.startswith('err:'):
+        kind, name = field.split(':', 1)
+        column = 'mean' if kind == 'tally' else 'rel_err'
+        return f"(SELECT {column} FROM tallies WHERE tallies.run = runs.id AND tallies.name = '{name}')"
+    if field not in RUN_FIELDS + ['id']:
+        raise SystemExit(f"unknown field '{field}' (columns: {', '.join(RUN_FIELDS)}, tally:<name>, err:<name>)")
+    return f"runs.{field}"
+
+
+def query(db, args):
+    fields = args.fields.split(',') if args.fields else ['time', 'particle', 'source', 'material', 'events', 'dir']
+    where, params = _filters(args)
+    sql = f"SELECT {', '.join(_select_expr(f) for f in fields)} FROM runs{where} ORDER BY runs.time DESC, runs.id DESC"
+    if args.latest:
+        sql += f" LIMIT {int(args.latest)}"
+    rows = db.execute(sql, params).fetchall()
+    _print(fields, rows, args.format)
+
+
+def aggregate(db, args):
+    by = args.by.split(',') if args.by else ['material']
+    where, params = _filters(args)
+    group = ', '.join(_select_expr(b) for b in by)
+    # 合成：总和 sum(N m) 的方差 = sum((N m R)^2)；均值 = sum(N m)/sum(N)
+    sql = (f"SELECT {group}, COUNT(*), SUM(runs.events), "
+           f"SUM(runs.events * t.mean), SUM((runs.events * t.mean * t.rel_err) * (runs.events * t.mean * t.rel_err)) "
+           f"FROM runs JOIN tallies t ON t.run = runs.id AND t.name = ?{where.replace(' WHERE ', ' AND ', 1) if where else ''} "
+           f"GROUP BY {group} ORDER BY {group}")
+    out = []
+    for row in db.execute(sql, [args.tally] + params):
+        keys, n_runs, events, s, var = row[:len(by)], row[len(by)], row[len(by) + 1], row[-2], row[-1]
+        mean = s / events if events else 0.0
+        rel = (var ** 0.5) / s if s else 0.0
+        out.append(tuple(keys) + (n_runs, events, mean, rel))
+    _print(by + ['runs', 'events', f'mean:{args.tally}', f'err:{args.tally}'], out, args.format)
+
+
+def _print(fields, rows, fmt):
+    if fmt == 'json':
+        print(json.dumps([dict(zip(fields, r)) for r in rows], indent=1, ensure_ascii=False))
+        return
+    sep = ',' if fmt == 'csv' else '\t'
+    if fmt == 'csv' or len(fields) > 1:
+        print(sep.join(fields) if fmt == 'csv' else "# " + sep.join(fields))
+    for r in rows:
+        print(sep.join('' if v is None else f"{v:.6g}" if isinstance(v, float) else str(v) for v in r))
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Query the exampleB1 run catalog")
+    ap.add_argument('command', choices=['sync', 'query', 'aggregate', 'sql'])
+    ap.add_argument('sql', nargs='?')
+    ap.add_argument('--data', default=None)
+    ap.add_argument('--scan', action='store_true', help="also index run directories not in the catalog")
+    ap.add_argument('--particle')
+    ap.add_argument('--source')
+    ap.add_argument('--material')
+    ap.add_argument('--job-key')
+    ap.add_argument('--config-hash')
+    ap.add_argument('--min-events', type=int)
+    ap.add_argument('--thickness-mm', type=float)
+    ap.add_argument('--no-merged', action='store_true', help="only independent runs, including merged ones")
+    ap.add_argument('--all', action='store_true', help="also list runs superseded by a merge")
+    ap.add_argument('--where')
+    ap.add_argument('--fields')
+    ap.add_argument('--latest', type=int)
+    ap.add_argument('--tally', default='gamma')
+    ap.add_argument('--by')
+    ap.add_argument('--format', choices=['tsv', 'csv', 'json'], default='tsv')
+    args = ap.parse_args()
+
+    base = args.data or data_dir()
+    if not os.path.isdir(base):
+        print(f"[CATALOG] data directory not found: {base}", file=sys.stderr)
+        sys.exit(2)
+    db, added = sync(base, scan=args.scan)
+    if args.command == 'sync':
+        total = db.execute("SELECT COUNT(*) FROM runs").fetchone()[0]
+        print(f"[CATALOG] {added} new runs, {total} in {os.path.join(base, CATALOG_DB)}")
+    elif args.command == 'query':
+        query(db, args)
+    elif args.command == 'aggregate':
+        aggregate(db, args)
+    elif args.command == 'sql':
+        if not args.sql:
+            raise SystemExit("sql: missing statement")
+        cur = db.execute(args.sql)
+        _print([d[0] for d in cur.description or []], cur.fetchall(), args.format)
+
+
+if __name__ == '__main__':
+    main()
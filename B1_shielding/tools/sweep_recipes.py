@@ -3,18 +3,30 @@ import os
 import sys
 import json
 import math
-import itertools
 import subprocess
 from datetime import datetime
 import shutil
 
+import result_cache
+from recipe_space import recipes_from_config
+from job_scheduler import job_seeds
+
 """
 批量配方扫描脚本：
 - 输入：JSON 配置文件，示例见同目录 sweep_recipes.example.json
 - 功能：
-  1) 在给定元素百分比范围与步长内生成所有配方，筛选总和≈100%
+  1) 在给定元素百分比范围与步长内直接枚举总和≈100%的配方（recipe_space.py，约束单纯形
+     上逐组分剪枝，不再生成笛卡尔积）；或用 sampling 在有界单纯形上做LHS/Halton采样
   2) 写入 macros/recipes/<recipe_name>.txt
   3) 为每个“源配置”生成运行宏并执行 exampleB1，每次 beamOn = events_per_run
+  4) server_mode=true 时不再逐个启动进程：写出一个队列文件，由单个
+     exampleB1 --queue 进程依次运行（初始化只做一次，换配方只替换玻璃材料）
+  5) parallel.jobs > 1 时由 job_scheduler.py 同时运行多个进程（CPU绑定、内存准入、
+     每个作业独立随机数种子、失败重试、进度与ETA）
+  6) use_cache=true（缺省）时先查 result_cache.py：同一作业键已有足够事件的run则跳过；
+     事件不足则只补跑差额（新种子）并在最后与已有run合并
+  7) 给出 prescreen 时先运行 exampleB1 --prescreen（不输运，只按截面数据计算 μ、
+     热中子俘获与快中子移出截面并做Pareto排序），只把前 keep_rank 层的配方送去完整输运
 
 JSON 配置字段：
 {
@@ -32,13 +44,26 @@ JSON 配置字段：
     {"name": "cf252", "macro": "macros/Cf252_neutron_test.mac"},
     {"name": "gamma662keV", "macro": "macros/gamma_shielding.mac"}
   ],
-  "dry_run": false
+  "dry_run": false,
+  "server_mode": false,
+  "use_cache": true,
+  "parallel": {"jobs": 4, "threads_per_job": 2, "mem_per_job_mb": 3000,
+               "max_retries": 1, "pin_cpus": true, "base_seed": 12345},
+  "prescreen": {"keep_rank": 1, "gamma_energy_MeV": 0.662, "max_recipes": 0},
+  "sampling": {"method": "grid"}
 }
 
 说明：
 - 组件名称需为 Geant4 NIST 或项目中可 FindOrBuild 的材料名。
 - sum_tolerance：允许配方总和与100%的偏差（%）。
+- sampling：可选；method 为 "grid"（缺省，按 step 枚举）、"lhs"、"halton" 或 "random"，
+  后三者取 n 个点（seed 可复现，decimals 为百分比小数位），只用各组分的 min/max，
+  总和严格为100。
 - sources.macro：一个可直接喂给 exampleB1 的宏文件。
+- parallel：可选；jobs 省略时取 CPU数/threads_per_job，mem_per_job_mb 为初始估计
+  （运行中按实测峰值RSS修正），日志在数据目录的 sched_logs/。
+- prescreen：可选；keep_rank 为保留的Pareto层数，max_recipes>0 时再按层号与 μ 截取前若干个，
+  排名写在 macros/recipes/prescreen.csv（可用 gamma_ana/gamma_composition_mu.C 作图）。
 """
 
 ROOT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
@@ -70,21 +95,6 @@ def load_config(path):
     with open(path, 'r') as f:
         return json.load(f)
 
-def frange(min_v, max_v, step):
-    v = min_v
-    while v <= max_v + 1e-9:
-        yield round(v, 6)
-        v += step
-
-def generate_combinations(components, sum_tolerance):
-    # 逐分量网格，按总和接近100筛选
-    ranges = [list(frange(c['min'], c['max'], c['step'])) for c in components]
-    names = [c['name'] for c in components]
-    for values in itertools.product(*ranges):
-        s = sum(values)
-        if abs(s - 100.0) <= sum_tolerance:
-            yield dict(zip(names, values))
-
 def write_recipe(recipe_dict, tag):
     os.makedirs(RECIPES_DIR, exist_ok=True)
     fname = f"recipe_{tag}.txt"
@@ -94,6 +104,50 @@ def write_recipe(recipe_dict, tag):
             f.write(f"{name} {pct}\n")
     return path
 
+def prescreen_recipes(recipe_paths, pre_cfg, dry_run=False):
+    """exampleB1 --prescreen：返回保留的配方路径（按层号、μ排序）；失败时原样返回"""
+    list_path = os.path.join(RECIPES_DIR, 'prescreen.list')
+    csv_path = os.path.join(RECIPES_DIR, 'prescreen.csv')
+    with open(list_path, 'w') as f:
+        f.write("\n".join(recipe_paths) + "\n")
+    cmd = [BUILD_EXE, '--prescreen', list_path, '--prescreen-out', csv_path,
+           '--prescreen-energy', str(pre_cfg.get('gamma_energy_MeV', 0.662))]
+    if dry_run:
+        print(f"[DRY] {' '.join(cmd)}")
+        return recipe_paths
+    print(f"[PRESCREEN] {' '.join(cmd)}")
+    if os.path.isfile(csv_path):
+        os.remove(csv_path)
+    rc = subprocess.call(cmd, cwd=ROOT_DIR, stdout=subprocess.DEVNULL, stderr=subprocess.STDOUT)
+    # 排名写出即以CSV为准（个别配方解析失败只记在CSV的 "# failed:" 行里）
+    if not os.path.isfile(csv_path):
+        print(f"[WARN] prescreen failed ({rc}); keeping all {len(recipe_paths)} recipes")
+        return recipe_paths
+
+    keep_rank = int(pre_cfg.get('keep_rank', 1))
+    max_recipes = int(pre_cfg.get('max_recipes', 0))
+    kept = []
+    failed = []
+    with open(csv_path) as f:
+        header = f.readline().strip().split(',')
+        i_rank, i_recipe = header.index('rank'), header.index('recipe')
+        for line in f:
+            if line.startswith('# failed: '):
+                failed.append(line[len('# failed: '):].strip())
+                continue
+            if not line.strip() or line.startswith('#'):
+                continue
+            cells = line.strip().split(',')
+            if int(cells[i_rank]) <= keep_rank:
+                kept.append(cells[i_recipe])
+    if max_recipes > 0:
+        kept = kept[:max_recipes]
+    print(f"[PRESCREEN] kept {len(kept)} of {len(recipe_paths)} recipes (Pareto rank <= {keep_rank}); "
+          f"ranking in {csv_path}")
+    if failed:
+        print(f"[WARN] {len(failed)} recipes failed to parse and were dropped: {' '.join(failed)}")
+    return kept
+
 def _analyze_base_macro(base_macro_path):
     has_gps = False
     has_source_mode = False
@@ -117,12 +171,13 @@ def _analyze_base_macro(base_macro_path):
         pass
     return has_gps, has_source_mode, has_init, gps_particle
 
-def build_macro_for_source(base_macro_path, recipe_path, events):
+def build_macro_for_source(base_macro_path, recipe_path, events, explicit_source_mode=False):
     # 生成一个临时宏：
     # 1) 设置玻璃配方（在初始化前）
     # 2) 如目标宏包含GPS命令但未显式设置/source/mode，则强制设为gps
     # 3) include 源宏
     # 4) 覆盖 beamOn 事件数
+    # explicit_source_mode：服务模式下源模式会沿用上一个作业，非GPS宏也要显式写 /source/mode
     ts = datetime.now().strftime('%Y%m%d_%H%M%S_%f')
     out_macro = os.path.join(MACROS_DIR, f"auto_run_{ts}.mac")
     has_gps, has_source_mode, has_init, gps_particle = _analyze_base_macro(base_macro_path)
@@ -132,6 +187,8 @@ def build_macro_for_source(base_macro_path, recipe_path, events):
         f.write(f"/det/glass/compositionFile {recipe_path}\n")
         if has_gps:
             f.write("/source/mode gps\n")
+        elif explicit_source_mode and not has_source_mode:
+            f.write(f"/source/mode {os.environ.get('NGAMMA_SOURCE_MODE', 'gps')}\n")
         # 2) 写入“过滤后的”基宏内容（去掉 /run/initialize、/run/beamOn、/det/glass/compositionFile）
         try:
             with open(base_macro_path, 'r') as bf:
@@ -161,6 +218,51 @@ def build_macro_for_source(base_macro_path, recipe_path, events):
         f.write(f"/run/beamOn {events}\n")
     return out_macro
 
+def _prepend_lines(macro_path, lines):
+    with open(macro_path) as f:
+        body = f.read()
+    with open(macro_path, 'w') as f:
+        for line in lines:
+            f.write(line + "\n")
+        f.write(body)
+
+def _uses_response_mode(base_macro_path):
+    try:
+        with open(base_macro_path, 'r') as bf:
+            return any(line.split()[:2] == ['/source/mode', 'response'] for line in bf)
+    except Exception:
+        return False
+
+def _job_env(base_macro_path):
+    # 推断是否需要强制 GPS 环境，防止外部环境变量覆盖
+    has_gps, has_source_mode, _, _ = _analyze_base_macro(base_macro_path)
+    env = {}
+    if has_gps and not has_source_mode:
+        env['NGAMMA_SOURCE_MODE'] = 'gps'
+    # 响应矩阵只在启动时启用（RunAction构造时定义直方图），宏里的 /source/mode response 来不及
+    if _uses_response_mode(base_macro_path):
+        env['NGAMMA_RESPONSE_MATRIX'] = '1'
+    return env
+
+def run_parallel(jobs, par_cfg, dry_run=False):
+    """jobs: [(name, macro_path, base_macro_path, seed_key)]；返回失败作业名列表"""
+    from job_scheduler import JobScheduler
+    sched = JobScheduler(jobs=par_cfg.get('jobs'),
+                         threads_per_job=par_cfg.get('threads_per_job', 1),
+                         mem_per_job_mb=par_cfg.get('mem_per_job_mb', 2000),
+                         mem_reserve_mb=par_cfg.get('mem_reserve_mb', 1000),
+                         max_retries=par_cfg.get('max_retries', 1),
+                         pin_cpus=par_cfg.get('pin_cpus', True),
+                         base_seed=par_cfg.get('base_seed', 12345))
+    for name, macro_path, base_macro_path, seed_key in jobs:
+        if dry_run:
+            print(f"[DRY] {name}: {BUILD_EXE} {macro_path}")
+            continue
+        sched.submit(name, macro_path, _job_env(base_macro_path), seed_key)
+    if dry_run:
+        return []
+    return sched.run()
+
 def run_sim(macro_path, base_macro_path, dry_run=False):
     if dry_run:
         print(f"[DRY] {BUILD_EXE} {macro_path}")
@@ -171,11 +273,8 @@ def run_sim(macro_path, base_macro_path, dry_run=False):
         except:
             pass
         return 0
-    # 推断是否需要强制 GPS 环境，防止外部环境变量覆盖
-    has_gps, has_source_mode, _, _ = _analyze_base_macro(base_macro_path)
     env = os.environ.copy()
-    if has_gps and not has_source_mode:
-        env['NGAMMA_SOURCE_MODE'] = 'gps'
+    env.update(_job_env(base_macro_path))
     # Persist a copy of the generated macro for debugging
     try:
         ts = datetime.now().strftime('%Y%m%d_%H%M%S_%f')
@@ -193,10 +292,32 @@ def run_sim(macro_path, base_macro_path, dry_run=False):
     # Keep the macro for post-mortem; do not delete
     return proc.returncode
 
+def write_queue(jobs):
+    """写出服务模式队列：每行 "- <宏文件>"。
+
+    配方只由宏中的 /det/glass/compositionFile 设置（作业键与配置哈希都以宏为准），
+    队列行写 "-" 避免同一配方再应用一次、重复重建几何；事件数已写在宏里。
+    """
+    ts = datetime.now().strftime('%Y%m%d_%H%M%S_%f')
+    queue_path = os.path.join(MACROS_DIR, f"auto_queue_{ts}.txt")
+    with open(queue_path, 'w') as f:
+        for _recipe_path, macro_path in jobs:
+            f.write(f"- {macro_path}\n")
+    return queue_path
+
+def run_server(queue_path, n_jobs, dry_run=False):
+    if dry_run:
+        print(f"[DRY] {BUILD_EXE} --queue {queue_path}  ({n_jobs} jobs)")
+        return 0
+    print(f"[RUN] {BUILD_EXE} --queue {queue_path}  ({n_jobs} jobs)")
+    proc = subprocess.run([BUILD_EXE, '--queue', queue_path])
+    return proc.returncode
+
 def cleanup_old_auto_macros():
-    """清理旧的auto_run_*.mac临时文件"""
+    """清理旧的auto_run_*.mac / auto_queue_*.txt临时文件"""
     import glob
     auto_macros = glob.glob(os.path.join(MACROS_DIR, "auto_run_*.mac"))
+    auto_macros += glob.glob(os.path.join(MACROS_DIR, "auto_queue_*.txt"))
     if auto_macros:
         print(f"[CLEAN] Found {len(auto_macros)} old temporary macro files")
         for macro in auto_macros:
@@ -216,23 +337,37 @@ def main():
     
     cfg = load_config(sys.argv[1])
 
-    components = cfg.get('components', [])
     tol = float(cfg.get('sum_tolerance', 0.5))
     events = int(cfg.get('events_per_run', 1000000))
     sources = cfg.get('sources', [])
     dry_run = bool(cfg.get('dry_run', False))
+    server_mode = bool(cfg.get('server_mode', False))
+    par_cfg = cfg.get('parallel') or {}
+    parallel = not server_mode and int(par_cfg.get('jobs') or 0) != 1 and bool(par_cfg)
 
-    combos = list(generate_combinations(components, tol))
-    print(f"[INFO] Generated {len(combos)} recipes (sum within ±{tol}%)")
+    sampling = (cfg.get('sampling') or {}).get('method', 'grid')
+    combos = list(recipes_from_config(cfg))
+    if sampling == 'grid':
+        print(f"[INFO] Generated {len(combos)} recipes (sum within ±{tol}%)")
+    else:
+        print(f"[INFO] Sampled {len(combos)} recipes ({sampling} on the bounded simplex)")
     # Always try to rebuild to pick up latest code changes
     rebuild()
     if not os.path.isfile(BUILD_EXE):
         print(f"[ERROR] Not found executable: {BUILD_EXE}")
         sys.exit(2)
 
-    for idx, recipe in enumerate(combos, 1):
-        tag = f"{idx:04d}"
-        recipe_path = write_recipe(recipe, tag)
+    recipe_paths = [write_recipe(recipe, f"{idx:04d}") for idx, recipe in enumerate(combos, 1)]
+    if cfg.get('prescreen'):
+        recipe_paths = prescreen_recipes(recipe_paths, cfg['prescreen'], dry_run)
+
+    use_cache = bool(cfg.get('use_cache', True)) and not dry_run
+    base_seed = par_cfg.get('base_seed', 12345)
+    queue_jobs = []
+    parallel_jobs = []
+    merge_keys = []
+    for recipe_path in recipe_paths:
+        tag = os.path.splitext(os.path.basename(recipe_path))[0][len('recipe_'):]
         print(f"[RECIPE] {recipe_path}")
         for src in sources:
             name = src.get('name', 'src')
@@ -241,11 +376,62 @@ def main():
                 print(f"[WARN] Skip source '{name}', macro not found: {macro}")
                 continue
             macro_abs = macro if os.path.isabs(macro) else os.path.join(ROOT_DIR, macro)
-            auto_macro = build_macro_for_source(macro_abs, recipe_path, events)
+            auto_macro = build_macro_for_source(macro_abs, recipe_path, events, explicit_source_mode=server_mode)
+            env = dict(os.environ)
+            env.update(_job_env(macro_abs))
+            key = result_cache.job_key(auto_macro, env)
+            run_events = events
+            if use_cache:
+                state, data = result_cache.lookup(key, events)
+                if state == 'hit':
+                    print(f"[CACHE] hit recipe {tag}, source {name}: {data}")
+                    os.remove(auto_macro)
+                    continue
+                if state == 'extend':
+                    runs, run_events = data
+                    merge_keys.append(key)
+                    print(f"[CACHE] extend recipe {tag}, source {name}: "
+                          f"{sum(r.get('events', 0) for r in runs)} events in {len(runs)} runs, {run_events} more")
+                    os.remove(auto_macro)
+                    if run_events <= 0:
+                        continue
+                    auto_macro = build_macro_for_source(macro_abs, recipe_path, run_events,
+                                                        explicit_source_mode=server_mode)
+            # 续算序号 = 已有run数：种子由作业键与序号导出，续算的run与已有run种子不同
+            seed_key = f"{key}:{result_cache.seed_offset(key) if use_cache else 0}"
+            header = [f"/metadata/jobKey {key}"]
+            if not parallel:
+                s1, s2 = job_seeds(base_seed, seed_key, 1)
+                header.append(f"/random/setSeeds {s1} {s2}")
+            _prepend_lines(auto_macro, header)
+            if server_mode:
+                queue_jobs.append((recipe_path, auto_macro))
+                continue
+            if parallel:
+                parallel_jobs.append((f"recipe_{tag}_{name}", auto_macro, macro_abs, seed_key))
+                continue
             rc = run_sim(auto_macro, macro_abs, dry_run)
             if rc != 0:
                 print(f"[WARN] Simulation returned non-zero ({rc}) for recipe {tag}, source {name}")
 
+    if server_mode and queue_jobs:
+        queue_path = write_queue(queue_jobs)
+        rc = run_server(queue_path, len(queue_jobs), dry_run)
+        if rc != 0:
+            print(f"[WARN] Queue run returned non-zero ({rc}); see '[QUEUE] done ... status=' lines")
+
+    if parallel and parallel_jobs:
+        failed = run_parallel(parallel_jobs, par_cfg, dry_run)
+        if failed:
+            print(f"[WARN] {len(failed)} jobs failed: {' '.join(failed)}")
+
+    # 续算的作业：把同一作业键下相容的run合并为一个结果目录
+    for key in merge_keys:
+        try:
+            result_cache.merge_for_key(key)
+        except Exception as e:
+            print(f"[WARN] merge for {key} failed: {e}")
+
 if __name__ == '__main__':
     main()
 